@@ -16,12 +16,16 @@
 
 #include <Analyzer.h>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "IEBusAnalyzerResults.hpp"
 #include "IEBusAnalyzerSettings.hpp"
+#include "IEBusDecoder.hpp"
 #include "IEBusSimulationDataGenerator.hpp"
+#include "IEBusTimingDetector.hpp"
 
-class ANALYZER_EXPORT IEBusAnalyzer : public Analyzer2 {
+class ANALYZER_EXPORT IEBusAnalyzer : public Analyzer2, private IEBusDecoderListener {
 private:
   using ResultPtr = std::unique_ptr<IEBusAnalyzerResults>;
 
@@ -31,7 +35,7 @@ public:
 
 public:
   auto SetupResults() -> void override;
-  [[noreturn]] [[noreturn]] auto WorkerThread() -> void override;
+  auto WorkerThread() -> void override;
 
 public:
   [[nodiscard]] auto GenerateSimulationData(U64 minimumSampleIndex, U32 sampleRate, SimulationChannelDescriptor** simulationChannels) -> U32 override;
@@ -42,12 +46,13 @@ public:
   [[nodiscard]] auto NeedsRerun() -> bool override;
 
 private:
-  // let's make this so we don't have DRY
-  auto update(U64 startingSample, U64& data1, U8 type, U8 flags) -> void;
-  // simple parity check :: returns 1 if even number of bits, returns 0 if odd number of bits
-  auto parity(U16 data) -> U8;
-  auto getAddress(bool master) -> bool;
-  auto getData(U8 dataType) -> int;
+  auto detectTiming(IEBusPrefetchEdgeSource& source, IEBusTiming& timing) -> void;
+
+private:
+  auto onMarker(std::uint64_t sample, Marker marker) -> void override;
+  auto onField(IEBusField const& field) -> void override;
+  auto onMessage(IEBusMessage const& message) -> void override;
+  auto onPulse(IEBusPulse const& pulse) -> void override;
 
 private:
   ResultPtr m_results = nullptr;
@@ -55,32 +60,19 @@ private:
 private:
   IEBusAnalyzerSettings m_settings;
   AnalyzerChannelData* m_serial;
+  Channel m_inputChannel;
 
   IEBusSimulationDataGenerator mSimulationDataGenerator;
   bool m_simulationInitialized;
 
   // Serial analysis vars:
   U32 m_sampleRateHz;
-  U32 m_startOfStopBitOffset;
-  U32 m_endOfStopBitOffset;
-  // tolerance for instability of readings
-  U32 m_toleranceStart;
-  U32 m_toleranceBit;
-  U32 m_zeroBitLen;
-  // measure width for each bit.
-  U64 m_measureWidth;
-  // to hold the start of the start bit
-  U64 m_startSampleNumberStart;
-  // to hold the finish of the start bit
-  U64 m_startSampleNumberFinish;
-  // to hold the start of the data bit
-  U64 m_startBitNumberStart;
-  // data output
-  U64 m_data;
-  // flags
-  // bit 0 = parity error
-  // bit 1 = NAK
-  U8 m_flags;
+  // no field frames or markers, one frame per message
+  bool m_messagesOnly = false;
+  // reused for the dissected fields and event hits of every message
+  std::string m_fields;
+  std::vector<std::uint32_t> m_eventHits;
+  std::string m_eventNames;
 };
 
 extern "C" ANALYZER_EXPORT const char* __cdecl GetAnalyzerName();
@@ -15,6 +15,17 @@
 #pragma once
 
 #include <AnalyzerResults.h>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "IEBusDissector.hpp"
+#include "IEBusEventMatcher.hpp"
+#include "IEBusMessage.hpp"
+#include "IEBusMessageDictionary.hpp"
+#include "IEBusResultFormatter.hpp"
+#include "IEBusSignalQuality.hpp"
+#include "IEBusTrafficStats.hpp"
 
 class IEBusAnalyzer;
 class IEBusAnalyzerSettings;
@@ -28,12 +39,63 @@ public:
   auto GenerateBubbleText(U64 frameIndex, Channel& channel, DisplayBase displayBase) -> void override;
   auto GenerateExportFile(const char* file, DisplayBase display_base, U32 export_type_user_id) -> void override;
 
+public:
+  // set before decoding starts, read-only afterwards
+  auto setDissectors(IEBusDissectorRegistry dissectors) -> void;
+  [[nodiscard]] auto getDissectors() const -> IEBusDissectorRegistry const&;
+
+public:
+  // compiled rules, set before decoding starts
+  auto setEventMatcher(IEBusEventMatcher matcher) -> void;
+  // fills hits with the rules the message stored at index triggers and keeps them for the event export,
+  // for as long as the message stays in the retention window
+  auto matchEvents(U64 index, IEBusMessage const& message, std::vector<std::uint32_t>& hits) -> void;
+  [[nodiscard]] auto getEventRule(std::uint32_t id) const -> IEBusEventRule const&;
+
+public:
+  // keep the payloads of the last maxMessages messages or maxSamples samples, zero keeps everything
+  auto setRetention(U64 maxMessages, U64 maxSamples) -> void;
+  // returns the message index, stored in Frame::mData1 of message frames
+  auto addMessage(IEBusMessage const& message) -> U64;
+  // false once the message has left the retention window
+  auto getMessage(U64 index, IEBusMessage& message) -> bool;
+  // message frames also carry the addresses, so the bubble survives the payload being dropped
+  [[nodiscard]] static auto makeMessageFrame(U64 index, IEBusMessage const& message) -> Frame;
+
+public:
+  // the widths in use once timing is known, clears the signal quality collected so far
+  auto setSignalTiming(IEBusTiming const& timing) -> void;
+  // called from the decoding thread only, the pulses are credited by addMessage
+  auto addPulse(IEBusPulse const& pulse) -> void;
+
 public:
   auto GenerateFrameTabularText(U64 frame_index, DisplayBase display_base) -> void override;
   auto GeneratePacketTabularText(U64 packet_id, DisplayBase display_base) -> void override;
   auto GenerateTransactionTabularText(U64 transaction_id, DisplayBase display_base) -> void override;
 
+private:
+  auto exportFrames(const char* file, DisplayBase display_base) -> void;
+  auto exportMessages(const char* file, U32 export_type_user_id) -> void;
+  auto exportStatistics(const char* file) -> void;
+  auto exportEvents(const char* file) -> void;
+  auto exportSignalQuality(const char* file) -> void;
+  auto formatFrame(Frame const& frame, DisplayBase displayBase, IEBusResultFormatter::Strings& strings) -> void;
+
 protected:
   IEBusAnalyzer* m_analyzer;
   IEBusAnalyzerSettings* m_settings;
+
+private:
+  IEBusResultFormatter m_formatter;
+  IEBusDissectorRegistry m_dissectors;
+
+private:
+  std::mutex m_messagesMutex;
+  IEBusMessageStore m_messages;
+  // covers every message, including those dropped from the store
+  IEBusTrafficStats m_stats;
+  IEBusSignalQuality m_signalQuality;
+  IEBusEventMatcher m_eventMatcher;
+  // in message order, evicted together with their messages
+  std::deque<IEBusEvent> m_events;
 };
@@ -16,8 +16,18 @@
 
 #include <AnalyzerSettings.h>
 #include <AnalyzerTypes.h>
+#include <string>
 
 class IEBusAnalyzerSettings : public AnalyzerSettings {
+public:
+  static auto constexpr EXPORT_FRAMES = 0;
+  static auto constexpr EXPORT_MESSAGES_CSV = 1;
+  static auto constexpr EXPORT_MESSAGES_BINARY = 2;
+  static auto constexpr EXPORT_MESSAGES_DELTA = 3;
+  static auto constexpr EXPORT_STATISTICS = 4;
+  static auto constexpr EXPORT_EVENTS = 5;
+  static auto constexpr EXPORT_SIGNAL_QUALITY = 6;
+
 public:
   IEBusAnalyzerSettings();
   ~IEBusAnalyzerSettings() override = default;
@@ -26,6 +36,15 @@ public:
   [[nodiscard]] auto getDataBitWidth() const -> int;
   [[nodiscard]] auto getInputChannel() const -> Channel;
   [[nodiscard]] auto getStartBitWidth() const -> int;
+  [[nodiscard]] auto isMessagesOnly() const -> bool;
+  [[nodiscard]] auto isAutoTiming() const -> bool;
+  // zero means unlimited, either limit being set also trims the data table rows
+  [[nodiscard]] auto getRetainMessages() const -> int;
+  [[nodiscard]] auto getRetainMinutes() const -> int;
+  // empty when no dissectors are loaded
+  [[nodiscard]] auto getDissectorFile() const -> std::string const&;
+  // empty when no events are matched
+  [[nodiscard]] auto getEventFile() const -> std::string const&;
 
 public:
   auto SetSettingsFromInterfaces() -> bool override;
@@ -39,9 +58,21 @@ private:
   int m_dataBitWidth;
   int m_startBitWidth;
   Channel m_inputChannel;
+  bool m_messagesOnly;
+  bool m_autoTiming;
+  int m_retainMessages;
+  int m_retainMinutes;
+  std::string m_dissectorFile;
+  std::string m_eventFile;
 
 private:
   AnalyzerSettingInterfaceInteger m_dataBitWidthInterface;
   AnalyzerSettingInterfaceChannel m_inputChannelInterface;
   AnalyzerSettingInterfaceInteger m_startBitWidthInterface;
+  AnalyzerSettingInterfaceBool m_messagesOnlyInterface;
+  AnalyzerSettingInterfaceBool m_autoTimingInterface;
+  AnalyzerSettingInterfaceInteger m_retainMessagesInterface;
+  AnalyzerSettingInterfaceInteger m_retainMinutesInterface;
+  AnalyzerSettingInterfaceText m_dissectorFileInterface;
+  AnalyzerSettingInterfaceText m_eventFileInterface;
 };
@@ -0,0 +1,97 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include "IEBusDecoder.hpp"
+
+// Read-only memory mapping of a recorded capture. Two layouts are understood:
+//   - Saleae Logic 2 digital binary export (version 0): header followed by f64 transition times in seconds
+//   - raw edge file: u64 sample numbers of every transition, nothing else
+class IEBusCaptureFile {
+public:
+  explicit IEBusCaptureFile(std::string const& path);
+  ~IEBusCaptureFile();
+
+  IEBusCaptureFile(IEBusCaptureFile const&) = delete;
+  auto operator=(IEBusCaptureFile const&) -> IEBusCaptureFile& = delete;
+
+public:
+  [[nodiscard]] auto isOpen() const -> bool;
+  [[nodiscard]] auto getError() const -> std::string const&;
+
+public:
+  [[nodiscard]] auto isSaleaeBinary() const -> bool;
+  // only known for Saleae exports, raw edge files report false
+  [[nodiscard]] auto isInitialHigh() const -> bool;
+  [[nodiscard]] auto getBeginTime() const -> double;
+  // Logic 2 puts the trigger at 0 s, sample numbers count from the earlier of the trigger and the begin time
+  [[nodiscard]] auto getOriginTime() const -> double;
+  // the sample at 0 s, pass it to the writers so their times match Logic 2
+  [[nodiscard]] auto getTriggerSample(double sampleRateHz) const -> std::uint64_t;
+  [[nodiscard]] auto getEdgeCount() const -> std::uint64_t;
+  [[nodiscard]] auto getEdges() const -> char const*;
+
+private:
+  auto map(std::string const& path) -> bool;
+  auto unmap() -> void;
+  auto parse() -> bool;
+
+private:
+  std::string m_error;
+  char const* m_data = nullptr;
+  std::size_t m_size = 0;
+#ifdef _WIN32
+  void* m_file = nullptr;
+  void* m_mapping = nullptr;
+#endif
+
+private:
+  bool m_saleaeBinary = false;
+  bool m_initialHigh = false;
+  double m_beginTime = 0.0;
+  std::uint64_t m_edgeCount = 0;
+  char const* m_edges = nullptr;
+};
+
+// Walks the mapped transitions in place, converting them to sample numbers on the fly.
+class IEBusCaptureEdgeSource : public IEBusEdgeSource {
+public:
+  IEBusCaptureEdgeSource(IEBusCaptureFile const& file, double sampleRateHz, bool initialHigh);
+
+public:
+  [[nodiscard]] auto getSampleNumber() -> std::uint64_t override;
+  [[nodiscard]] auto isHigh() -> bool override;
+  [[nodiscard]] auto isEdgeAvailable() -> bool override;
+  auto advanceToNextEdge() -> bool override;
+
+public:
+  // converts up to samples.size() edges in one go, returns how many were converted
+  auto readSamples(std::span<std::uint64_t> samples) -> std::size_t;
+
+private:
+  [[nodiscard]] auto getSampleAt(std::uint64_t index) const -> std::uint64_t;
+
+private:
+  IEBusCaptureFile const& m_file;
+  double m_sampleRateHz;
+  bool m_high;
+  std::uint64_t m_next = 0;
+  std::uint64_t m_sampleNumber = 0;
+};
@@ -0,0 +1,152 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "IEBusMessage.hpp"
+
+// bit timing in samples
+struct IEBusTiming {
+  std::uint64_t startBitWidth = 0;
+  std::uint64_t dataBitWidth = 0;
+
+  [[nodiscard]] static auto fromMicroseconds(double startBitWidthUs, double dataBitWidthUs, double sampleRateHz) -> IEBusTiming;
+};
+
+// where the decoder pulls its edges from (analyzer channel, capture file, ...)
+class IEBusEdgeSource {
+public:
+  virtual ~IEBusEdgeSource() = default;
+
+public:
+  [[nodiscard]] virtual auto getSampleNumber() -> std::uint64_t = 0;
+  [[nodiscard]] virtual auto isHigh() -> bool = 0;
+  // whether advancing would return without waiting for more data
+  [[nodiscard]] virtual auto isEdgeAvailable() -> bool;
+  // returns false once there are no more edges
+  virtual auto advanceToNextEdge() -> bool = 0;
+};
+
+// one measured high pulse of a message
+struct IEBusPulse {
+  enum class Kind : std::uint8_t { Start, One, Zero, Ack };
+
+  std::uint64_t sample = 0;
+  std::uint64_t width = 0;
+  Kind kind = Kind::Start;
+  // driven by the slave: its ACKs on writes, its length, data and parity bits on reads
+  bool fromSlave = false;
+  // false for an ACK bit read as a one, the line stays at one when nobody acknowledges
+  bool driven = true;
+  // within the outer quarter of the tolerance window, or a data bit outside both windows
+  bool nearThreshold = false;
+};
+
+// receives everything the decoder finds, in sample order
+class IEBusDecoderListener {
+public:
+  enum class Marker { UpArrow, Start, Dot, One, Zero, ErrorX };
+
+public:
+  virtual ~IEBusDecoderListener() = default;
+
+public:
+  virtual auto onMarker(std::uint64_t sample, Marker marker) -> void;
+  virtual auto onField(IEBusField const& field) -> void;
+  virtual auto onMessage(IEBusMessage const& message) -> void;
+  // every bit of a message, starting with its start bit, before the markers of that bit
+  virtual auto onPulse(IEBusPulse const& pulse) -> void;
+};
+
+// Push-based IEBus decoder. Edges can arrive one at a time or in chunks of any size, a message split
+// across chunks is resumed where the previous chunk left it. Nothing is buffered besides the message
+// being assembled, so live streams, file chunks and the analyzer channel all feed the same engine.
+class IEBusDecoder {
+public:
+  IEBusDecoder(IEBusTiming const& timing, IEBusDecoderListener& listener);
+
+public:
+  // line level at the first sample, call before the first edge or to start over
+  auto setLineState(std::uint64_t sample, bool high) -> void;
+  // high is the line level after the edge
+  auto pushEdge(std::uint64_t sample, bool high) -> void;
+  // transitions only, each one toggles the line level
+  auto pushEdges(std::span<std::uint64_t const> samples) -> void;
+  // pushes every edge of the source from its current position
+  auto run(IEBusEdgeSource& source) -> void;
+
+private:
+  // one state per field, the bits of each field are laid out in a table in the source file
+  enum class State : std::uint8_t { Hunt, Header, Master, Slave, Control, Length, Data };
+
+private:
+  auto onRisingEdge(std::uint64_t sample) -> void;
+  auto onFallingEdge(std::uint64_t sample) -> void;
+  auto beginMessage() -> void;
+  auto decodeBit() -> void;
+  auto completeField(std::uint8_t type) -> void;
+  auto completeMessage() -> void;
+
+private:
+  auto markBit(bool one) -> void;
+  auto checkParity() -> void;
+  auto checkAck() -> void;
+  auto update(std::uint64_t startingSample, std::uint8_t type, std::uint8_t flags) -> void;
+  [[nodiscard]] auto isOneBit() const -> bool;
+  [[nodiscard]] auto isZeroBit() const -> bool;
+  [[nodiscard]] auto isNearThreshold(std::uint64_t nominal, std::uint64_t tolerance) const -> bool;
+  auto reportPulse(IEBusPulse::Kind kind, bool fromSlave, bool nearThreshold) -> void;
+
+private:
+  IEBusDecoderListener& m_listener;
+
+private:
+  std::uint64_t m_startBitWidth;
+  std::uint64_t m_oneBitLen;
+  std::uint64_t m_zeroBitLen;
+  // tolerance for instability of readings
+  std::uint64_t m_toleranceStart;
+  std::uint64_t m_toleranceBit;
+
+private:
+  State m_state = State::Hunt;
+  bool m_high = false;
+  // a falling edge only measures something after a rising one
+  bool m_risen = false;
+  // bit position inside the current field, data bits first, then parity and ACK
+  std::uint8_t m_bit = 0;
+  // data bytes still expected
+  std::uint8_t m_remaining = 0;
+  // measure width for each bit.
+  std::uint64_t m_measureWidth = 0;
+  // to hold the start of the start bit, then of the current field
+  std::uint64_t m_startSampleNumberStart = 0;
+  // to hold the end of the last high pulse
+  std::uint64_t m_startSampleNumberFinish = 0;
+  // to hold the start of the data bit
+  std::uint64_t m_startBitNumberStart = 0;
+  // data output
+  std::uint64_t m_data = 0;
+  // flags
+  // bit 0 = parity error
+  // bit 1 = NAK
+  std::uint8_t m_flags = 0;
+  // xor of the data bits shifted in so far
+  std::uint8_t m_parity = 0;
+  // message being assembled, reused so the payload buffer is allocated once
+  IEBusMessage m_message;
+};
@@ -0,0 +1,79 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+#include "IEBusDecoder.hpp"
+#include "IEBusMessage.hpp"
+#include "IEBusMessageDictionary.hpp"
+#include "IEBusText.hpp"
+
+// CSV export that collapses periodic traffic. Each (master, slave, control, broadcast) stream writes its
+// first message and every change of payload or flags in full; runs of identical messages in
+// between are written as one "repeat" line with their count and mean period, stamped with the
+// run's last message. Lines are held back until no pending repeat line can precede them, so the
+// file stays in time order; a run silent for MAX_SILENT_MESSAGES messages is closed with its
+// repeat line right away, so at most that many lines wait.
+class IEBusDeltaWriter : public IEBusDecoderListener {
+public:
+  static auto constexpr MAX_SILENT_MESSAGES = 4096;
+
+public:
+  IEBusDeltaWriter(std::ostream& stream, double sampleRateHz, std::uint64_t triggerSample = 0);
+
+public:
+  // id must come from one dictionary for the whole export, onMessage uses its own
+  auto write(IEBusMessage const& message, std::uint32_t id) -> void;
+  // write the repeat lines still pending, call once after the last message
+  auto finish() -> void;
+  auto onMessage(IEBusMessage const& message) -> void override;
+
+private:
+  struct Stream {
+    std::uint32_t id;
+    std::uint8_t flags;
+    std::uint16_t master;
+    std::uint16_t slave;
+    std::uint8_t control;
+    bool hasControl;
+    std::uint64_t runStartSample;
+    std::uint64_t lastSample;
+    std::uint64_t lastMessage;
+    std::uint64_t repeats;
+  };
+
+private:
+  auto writeMessage(char const* event, IEBusMessage const& message) -> void;
+  auto writeRepeats(Stream const& stream) -> void;
+  auto queueLine(std::uint64_t sample) -> void;
+  auto flushLines() -> void;
+
+private:
+  std::ostream& m_stream;
+  IEBusTimeBase m_time;
+
+private:
+  IEBusMessageDictionary m_dictionary;
+  std::unordered_map<std::uint32_t, Stream> m_streams;
+  std::uint64_t m_messages = 0;
+  std::ostringstream m_line;
+  std::multimap<std::uint64_t, std::string> m_lines;
+};
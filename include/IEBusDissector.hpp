@@ -0,0 +1,83 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+#include <istream>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "IEBusMessage.hpp"
+
+struct IEBusCommandField {
+  std::string name;
+  std::uint8_t offset = 0;
+  // payload bytes taken, 0 runs to the end of the payload
+  std::uint8_t length = 1;
+};
+
+// An application-layer command recognised by slave address, control code and the first payload bytes.
+struct IEBusCommand {
+  static auto constexpr ANY_SLAVE = std::uint16_t{0xFFFF};
+
+  std::string name;
+  std::uint16_t slave = ANY_SLAVE;
+  std::uint8_t control = 0;
+  std::vector<std::uint8_t> prefix;
+  std::vector<IEBusCommandField> fields;
+};
+
+// Maps messages to commands with a handful of hash lookups, the longest matching prefix wins and an
+// exact slave beats ANY_SLAVE. Messages to slaves without commands are rejected by a bitset test.
+//
+// Definition files hold one command per line, '#' starts a comment:
+//   <slave|*> <control> <prefix|-> <name> [<field>:<offset>[-[<last>]]]...
+// addresses, control and prefix bytes are hex, prefix bytes are separated by dots, e.g.
+//   360 F 00.25.80 cd-play disc:3 track:4 time:5-6 rest:7-
+class IEBusDissectorRegistry {
+public:
+  static auto constexpr MAX_PREFIX = 4;
+
+public:
+  // a command with the same slave, control and prefix as an earlier one replaces it
+  auto add(IEBusCommand command) -> void;
+  auto load(std::istream& stream, std::string& error) -> bool;
+  auto loadFile(std::string const& path, std::string& error) -> bool;
+  auto clear() -> void;
+
+public:
+  // messages that ended before their control field never match
+  [[nodiscard]] auto find(IEBusMessage const& message) const -> IEBusCommand const*;
+  // name of a control code of the IEBus standard, nullptr for reserved codes
+  [[nodiscard]] static auto getControlName(std::uint8_t control) -> char const*;
+  // "disc=0x01 track=0x05", fields past the end of the payload are left out
+  static auto formatFields(IEBusCommand const& command, IEBusMessage const& message, std::string& text) -> void;
+
+private:
+  [[nodiscard]] static auto makeKey(std::uint16_t slave, std::uint8_t control, std::span<std::uint8_t const> prefix) -> std::uint64_t;
+  [[nodiscard]] auto lookup(std::uint16_t slave, std::uint8_t control, std::span<std::uint8_t const> prefix) const -> IEBusCommand const*;
+
+private:
+  std::vector<IEBusCommand> m_commands;
+  std::unordered_map<std::uint64_t, std::uint32_t> m_index;
+  // slaves with commands of their own
+  std::bitset<4096> m_slaves;
+  bool m_anySlave = false;
+  // bit n is set when some command has an n byte prefix
+  std::uint8_t m_prefixLengths = 0;
+};
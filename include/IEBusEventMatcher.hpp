@@ -0,0 +1,115 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "IEBusMessage.hpp"
+
+struct IEBusEventRule {
+  // one payload byte, bits outside mask match anything
+  struct BytePattern {
+    std::uint8_t value = 0;
+    std::uint8_t mask = 0;
+  };
+
+  std::string name;
+  // masks select the address bits compared, 0 matches every address
+  std::uint16_t master = 0;
+  std::uint16_t masterMask = 0;
+  std::uint16_t slave = 0;
+  std::uint16_t slaveMask = 0;
+  // bit n accepts control code n; a message without a control field only matches when all are accepted
+  std::uint16_t controls = 0xFFFF;
+  // IEBusFlag bits the message must carry
+  std::uint8_t flags = 0;
+  std::optional<bool> broadcast;
+  // never matches a message without a control field
+  std::optional<std::uint8_t> length;
+  // matched against the start of the payload
+  std::vector<BytePattern> data;
+  // with a count, a hit needs that many matches within the window, then counting starts over
+  std::uint32_t rateCount = 0;
+  double rateWindowSeconds = 0.0;
+};
+
+// a rule hit, kept when events are exported after decoding; message is an IEBusMessageStore index
+struct IEBusEvent {
+  std::uint32_t rule = 0;
+  std::uint64_t message = 0;
+};
+
+// Compiles any number of rules into lookup tables over the message header and one table per payload
+// depth, so each message costs a few bitset ANDs plus one more per payload byte up to the longest pattern.
+//
+// Rule files hold one rule per line, '#' starts a comment:
+//   <name> [master=<hex>[/<mask>]] [slave=<hex>[/<mask>]] [control=<hex>[,<hex>]...] [data=<pattern>]
+//          [length=<n>] [nak] [parity-error] [broadcast|individual] [rate=<count>/<seconds>]
+// data patterns are dot separated hex bytes where '?' stands for any nibble, e.g.
+//   cd-eject-nak slave=360 control=F data=00.25.8? nak
+//   nak-burst nak rate=10/0.5
+class IEBusEventMatcher {
+public:
+  auto add(IEBusEventRule rule) -> void;
+  auto load(std::istream& stream, std::string& error) -> bool;
+  auto loadFile(std::string const& path, std::string& error) -> bool;
+  // builds the tables, call after the last rule was added and before matching
+  auto compile(double sampleRateHz) -> void;
+
+public:
+  [[nodiscard]] auto empty() const -> bool;
+  [[nodiscard]] auto getRule(std::uint32_t id) const -> IEBusEventRule const&;
+  // fills hits with the ids of the rules the message triggers, in rule order
+  auto match(IEBusMessage const& message, std::vector<std::uint32_t>& hits) -> void;
+
+private:
+  using Bits = std::uint64_t;
+
+private:
+  auto compileHeader() -> void;
+  auto compilePayload() -> void;
+  [[nodiscard]] auto bits(std::vector<Bits>& table, std::size_t row) -> Bits*;
+  [[nodiscard]] auto passesRate(std::uint32_t id, std::uint64_t sample) -> bool;
+
+private:
+  std::vector<IEBusEventRule> m_rules;
+  // bitset words per row
+  std::size_t m_words = 0;
+
+private:
+  // one row of rule bits per address, control code and (header, flags) combination
+  std::vector<Bits> m_masterRules;
+  std::vector<Bits> m_slaveRules;
+  std::vector<Bits> m_controlRules;
+  std::vector<Bits> m_statusRules;
+  std::vector<Bits> m_lengthRules;
+
+private:
+  // rules still matching after payload byte b at depth d, one row per (d, b)
+  std::vector<Bits> m_payloadRules;
+  // rules whose pattern is at most d bytes long
+  std::vector<Bits> m_patternEnds;
+  std::size_t m_maxDepth = 0;
+
+private:
+  std::vector<std::uint64_t> m_rateWindows;
+  std::vector<std::deque<std::uint64_t>> m_recentMatches;
+  std::vector<Bits> m_candidates;
+};
@@ -0,0 +1,41 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "IEBusDecoder.hpp"
+#include "IEBusEventMatcher.hpp"
+#include "IEBusMessage.hpp"
+#include "IEBusText.hpp"
+
+// CSV export of rule hits, one line per (rule, message) pair.
+class IEBusEventWriter : public IEBusDecoderListener {
+public:
+  IEBusEventWriter(std::ostream& stream, IEBusEventMatcher& matcher, double sampleRateHz, std::uint64_t triggerSample = 0);
+
+public:
+  auto write(std::uint32_t rule, IEBusMessage const& message) -> void;
+  // matches the message and writes every hit
+  auto onMessage(IEBusMessage const& message) -> void override;
+
+private:
+  std::ostream& m_stream;
+  IEBusEventMatcher& m_matcher;
+  IEBusTimeBase m_time;
+  std::vector<std::uint32_t> m_hits;
+};
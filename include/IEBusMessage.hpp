@@ -0,0 +1,66 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// field types, stored in Frame::mData2 by the plugin
+struct IEBusFieldType {
+  static auto constexpr SLAVE = 0;
+  static auto constexpr MASTER = 1;
+  static auto constexpr CONTROL = 100;
+  static auto constexpr LENGTH = 101;
+  static auto constexpr DATA = 102;
+  static auto constexpr HEADER = 103;
+  static auto constexpr START = 104;
+  // a whole message, Frame::mData1 holds its index in the message store
+  static auto constexpr MESSAGE = 105;
+};
+
+// field and message flags, stored in Frame::mFlags by the plugin
+struct IEBusFlag {
+  static auto constexpr PARITY_ERROR = 1 << 0;
+  static auto constexpr NAK = 1 << 1;
+};
+
+// one decoded field (start bit, header, address, control, length or data byte)
+struct IEBusField {
+  std::uint64_t startSample = 0;
+  std::uint64_t endSample = 0;
+  std::uint64_t value = 0;
+  std::uint8_t type = 0;
+  std::uint8_t flags = 0;
+};
+
+// one decoded message, from the start bit to the last acknowledged field
+struct IEBusMessage {
+  std::uint64_t startSample = 0;
+  std::uint64_t endSample = 0;
+  std::uint8_t header = 0;
+  std::uint16_t master = 0;
+  std::uint16_t slave = 0;
+  std::uint8_t control = 0;
+  std::uint8_t length = 0;
+  std::uint8_t flags = 0;
+  // false when the slave NAKed its address: control and length were never sent and read 0
+  bool hasControl = false;
+  std::vector<std::uint8_t> data;
+
+  // the header bit is 0 for broadcasts and 1 for individual communication
+  [[nodiscard]] auto isBroadcast() const -> bool {
+    return header == 0;
+  }
+};
@@ -0,0 +1,106 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "IEBusMessage.hpp"
+
+// Interns identical (header, master, slave, control, length, payload) tuples so periodic traffic is
+// stored once. Payloads live back to back in a single pool.
+class IEBusMessageDictionary {
+public:
+  struct Entry {
+    std::uint64_t hash;
+    std::uint32_t payloadOffset;
+    std::uint16_t payloadLength;
+    std::uint16_t master;
+    std::uint16_t slave;
+    std::uint8_t header;
+    std::uint8_t control;
+    std::uint8_t length;
+    bool hasControl;
+  };
+
+public:
+  auto intern(IEBusMessage const& message) -> std::uint32_t;
+  auto clear() -> void;
+
+public:
+  [[nodiscard]] auto size() const -> std::size_t;
+  [[nodiscard]] auto getEntry(std::uint32_t id) const -> Entry const&;
+  [[nodiscard]] auto getPayload(std::uint32_t id) const -> std::span<std::uint8_t const>;
+  // fills everything but the samples and flags, which belong to each occurrence
+  auto expand(std::uint32_t id, IEBusMessage& message) const -> void;
+
+public:
+  // the (master, slave, control, broadcast) stream a message belongs to, as the delta and statistics
+  // exports group traffic; messages that ended before their control field are a stream of their own
+  [[nodiscard]] static auto streamKey(IEBusMessage const& message) -> std::uint32_t;
+
+private:
+  [[nodiscard]] static auto hash(IEBusMessage const& message) -> std::uint64_t;
+  [[nodiscard]] auto matches(Entry const& entry, IEBusMessage const& message) const -> bool;
+
+private:
+  std::vector<Entry> m_entries;
+  std::vector<std::uint8_t> m_payloads;
+  std::unordered_multimap<std::uint64_t, std::uint32_t> m_index;
+};
+
+// Decoded messages as (dictionary id, samples, flags) records. Indices count every message ever
+// added; with a retention limit the oldest records are dropped and their indices stop resolving.
+class IEBusMessageStore {
+public:
+  struct Record {
+    std::uint64_t startSample;
+    std::uint64_t endSample;
+    std::uint32_t id;
+    std::uint8_t flags;
+  };
+
+public:
+  // zero disables the limit, maxSamples is measured between message starts
+  auto setRetention(std::uint64_t maxMessages, std::uint64_t maxSamples) -> void;
+  // returns the index of the new record
+  auto add(IEBusMessage const& message) -> std::uint64_t;
+  auto clear() -> void;
+
+public:
+  [[nodiscard]] auto size() const -> std::size_t;
+  [[nodiscard]] auto getFirstIndex() const -> std::uint64_t;
+  [[nodiscard]] auto getEndIndex() const -> std::uint64_t;
+  [[nodiscard]] auto contains(std::uint64_t index) const -> bool;
+  [[nodiscard]] auto getRecord(std::uint64_t index) const -> Record const&;
+  [[nodiscard]] auto getDictionary() const -> IEBusMessageDictionary const&;
+  auto get(std::uint64_t index, IEBusMessage& message) const -> void;
+
+private:
+  auto evict() -> void;
+  // rebuilds the dictionary from the retained records once most of its entries are unused
+  auto compact() -> void;
+
+private:
+  IEBusMessageDictionary m_dictionary;
+  std::deque<Record> m_records;
+  std::uint64_t m_firstIndex = 0;
+  std::uint64_t m_maxMessages = 0;
+  std::uint64_t m_maxSamples = 0;
+};
@@ -0,0 +1,56 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "IEBusDecoder.hpp"
+#include "IEBusDissector.hpp"
+#include "IEBusMessage.hpp"
+#include "IEBusText.hpp"
+
+// Writes one record per message, shared by the plugin export and iebus-decode. With dissectors the
+// CSV gains Command and Fields columns, the binary layout stays the same.
+//
+// Binary layout (little endian):
+//   header: "IEBUSMSG", u32 version, u32 reserved, f64 sample rate
+//   record: u64 start sample, u64 end sample, u16 master, u16 slave, u8 header, u8 control,
+//           u8 length, u8 flags, u16 byte count, payload bytes
+//   flags:  bit 0 parity error, bit 1 NAK, bit 2 control and length were received (version 2);
+//           without bit 2 the slave NAKed its address and control and length read 0
+class IEBusMessageWriter : public IEBusDecoderListener {
+public:
+  enum class Format { Csv, Binary };
+
+public:
+  IEBusMessageWriter(std::ostream& stream, Format format, double sampleRateHz, std::uint64_t triggerSample = 0, IEBusDissectorRegistry const* dissectors = nullptr);
+
+public:
+  auto write(IEBusMessage const& message) -> void;
+  auto onMessage(IEBusMessage const& message) -> void override;
+
+private:
+  auto writeCsv(IEBusMessage const& message) -> void;
+  auto writeBinary(IEBusMessage const& message) -> void;
+
+private:
+  std::ostream& m_stream;
+  Format m_format;
+  IEBusTimeBase m_time;
+  IEBusDissectorRegistry const* m_dissectors;
+  std::string m_fields;
+};
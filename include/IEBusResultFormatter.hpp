@@ -0,0 +1,60 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <AnalyzerResults.h>
+#include <AnalyzerTypes.h>
+#include <array>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "IEBusDissector.hpp"
+#include "IEBusMessage.hpp"
+
+// Builds the bubble and tabular strings for field and message frames. Every value a field can hold is
+// formatted once per display base, so zooming only concatenates cached strings.
+class IEBusResultFormatter {
+public:
+  static auto constexpr TEXT_LENGTH = 256;
+
+  struct Strings {
+    std::array<char, TEXT_LENGTH> shortText;
+    std::array<char, TEXT_LENGTH> mediumText;
+    std::array<char, TEXT_LENGTH> longText;
+  };
+
+public:
+  // "M", "Master 0x190", "Master addr 0x190 parity OK"
+  auto format(Frame const& frame, DisplayBase displayBase, Strings& strings) -> void;
+  // "0x190>0x1FF", "0x190 > 0x1FF 0xF [3]", "Master 0x190 > Slave 0x1FF control 0xF length 3: 0x11 0x22 0x33",
+  // a dissected command adds its name to the medium text and its name and fields to the long one,
+  // without one both name the control code
+  auto formatMessage(IEBusMessage const& message, DisplayBase displayBase, Strings& strings, IEBusCommand const* command = nullptr) -> void;
+  [[nodiscard]] auto getNumberString(U64 value, U8 type, DisplayBase displayBase) -> char const*;
+
+private:
+  // one table per field width: header bit, control nibble, byte, address
+  struct NumberTables {
+    std::once_flag built;
+    std::array<std::vector<std::string>, 4> byWidth;
+  };
+
+private:
+  auto getTables(DisplayBase displayBase) -> NumberTables const&;
+
+private:
+  std::array<NumberTables, AsciiHex + 1> m_tables;
+};
@@ -0,0 +1,81 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+
+#include "IEBusDecoder.hpp"
+#include "IEBusMessage.hpp"
+
+// Pulse width statistics per transmitting node. Pulses are collected per message and credited to its
+// master and slave once the message completes. Abandoned messages are dropped, and so are NAKed ACK bits,
+// which nobody drove, and the slave side of broadcasts. Memory is bounded by the number of addresses seen.
+class IEBusSignalQuality : public IEBusDecoderListener {
+public:
+  static auto constexpr BINS = 20;
+  static auto constexpr KINDS = 4;
+
+  // streaming min/max/mean/variance and a histogram of one pulse kind, widths in samples
+  struct Accumulator {
+    std::uint64_t count = 0;
+    std::uint64_t min = 0;
+    std::uint64_t max = 0;
+    double mean = 0.0;
+    // sum of squared deviations from the mean
+    double m2 = 0.0;
+    std::uint64_t nearThreshold = 0;
+    // below the range, BINS bins, above the range
+    std::array<std::uint64_t, BINS + 2> histogram{};
+
+    auto add(std::uint64_t width, std::size_t bin, bool near) -> void;
+    auto merge(Accumulator const& other) -> void;
+    [[nodiscard]] auto variance() const -> double;
+  };
+
+public:
+  explicit IEBusSignalQuality(IEBusTiming const& timing = {});
+
+public:
+  // also clears everything collected so far
+  auto setTiming(IEBusTiming const& timing) -> void;
+  auto onPulse(IEBusPulse const& pulse) -> void override;
+  auto onMessage(IEBusMessage const& message) -> void override;
+
+public:
+  // one CSV line per node and pulse kind, widths in uS
+  auto write(std::ostream& stream, double sampleRateHz) const -> void;
+
+private:
+  struct Range {
+    std::uint64_t from = 0;
+    std::uint64_t binWidth = 1;
+  };
+
+  using Accumulators = std::array<Accumulator, KINDS>;
+
+private:
+  [[nodiscard]] auto getBin(IEBusPulse::Kind kind, std::uint64_t width) const -> std::size_t;
+  static auto mergeInto(Accumulators& node, Accumulators& pending) -> void;
+
+private:
+  std::array<Range, KINDS> m_ranges;
+  std::unordered_map<std::uint16_t, Accumulators> m_nodes;
+  // the message being decoded, by the side driving the line
+  Accumulators m_masterPending;
+  Accumulators m_slavePending;
+};
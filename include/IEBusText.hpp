@@ -0,0 +1,53 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string_view>
+
+#include "IEBusMessage.hpp"
+
+// Sample numbers to seconds relative to the trigger, as every export prints them.
+struct IEBusTimeBase {
+  double sampleRateHz = 1.0;
+  std::uint64_t triggerSample = 0;
+
+  [[nodiscard]] auto toSeconds(std::uint64_t sample) const -> double;
+};
+
+// Formatting shared by the CSV writers and parsing shared by the definition file readers.
+class IEBusText {
+public:
+  // "XX " per byte of the longest payload
+  static auto constexpr HEX_BYTES_LENGTH = 256 * 3;
+
+public:
+  // "11 22 33" into out, cut short when it doesn't fit; returns the characters written
+  static auto formatHexBytes(std::span<std::uint8_t const> bytes, std::span<char> out) -> std::size_t;
+  // the Master,Slave,Control,Length,Data,NAK,Parity Error columns, without a leading or trailing comma
+  static auto writeMessageColumns(std::ostream& stream, IEBusMessage const& message) -> void;
+  // "0xF", empty for a message that ended before its control field
+  [[nodiscard]] static auto formatControl(std::uint8_t control, bool hasControl) -> char const*;
+  // one free text column, quoted when it holds a comma, quote or line break
+  static auto writeCsvText(std::ostream& stream, std::string_view text) -> void;
+
+public:
+  // the whole text has to be one number no larger than max
+  [[nodiscard]] static auto parseHex(std::string_view text, unsigned max, unsigned& value) -> bool;
+  [[nodiscard]] static auto parseDecimal(std::string_view text, unsigned max, unsigned& value) -> bool;
+};
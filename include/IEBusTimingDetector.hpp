@@ -0,0 +1,82 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "IEBusDecoder.hpp"
+
+struct IEBusDetectedTiming {
+  IEBusTiming timing;
+  // mean high time of each cluster, in samples
+  double startWidth = 0.0;
+  double oneWidth = 0.0;
+  double zeroWidth = 0.0;
+  std::size_t pulses = 0;
+};
+
+// Finds the start, one and zero bit clusters (ACK bits are ordinary one/zero bits) in a
+// histogram of the high pulse widths at the beginning of a capture.
+class IEBusTimingDetector {
+public:
+  static auto constexpr DEFAULT_EDGES = 8192;
+
+public:
+  explicit IEBusTimingDetector(std::size_t maxEdges = DEFAULT_EDGES);
+
+public:
+  // high is the line state after the edge, returns false once enough edges were seen
+  auto addEdge(std::uint64_t sample, bool high) -> bool;
+  // feeds edges from the source's current position, leaving it after the last one used
+  auto scan(IEBusEdgeSource& source) -> void;
+  [[nodiscard]] auto detect() const -> std::optional<IEBusDetectedTiming>;
+
+private:
+  std::size_t m_maxEdges;
+  std::size_t m_edges = 0;
+  std::optional<std::uint64_t> m_riseSample;
+  std::vector<std::uint64_t> m_widths;
+};
+
+// Remembers the first edges of another source so they can be decoded again after detection.
+class IEBusPrefetchEdgeSource : public IEBusEdgeSource {
+public:
+  explicit IEBusPrefetchEdgeSource(IEBusEdgeSource& source);
+
+public:
+  // fills the buffer up to maxEdges edges, stopping early when the source has none at hand; call again
+  // to top it up once more data arrived, before the edges are replayed
+  auto prefetch(std::size_t maxEdges) -> void;
+  [[nodiscard]] auto isInitialHigh() const -> bool;
+  [[nodiscard]] auto getEdges() const -> std::span<std::uint64_t const>;
+
+public:
+  [[nodiscard]] auto getSampleNumber() -> std::uint64_t override;
+  [[nodiscard]] auto isHigh() -> bool override;
+  [[nodiscard]] auto isEdgeAvailable() -> bool override;
+  auto advanceToNextEdge() -> bool override;
+
+private:
+  IEBusEdgeSource& m_source;
+  std::uint64_t m_initialSample = 0;
+  bool m_initialHigh = false;
+  std::vector<std::uint64_t> m_edges;
+  // edges replayed so far, past the buffer the wrapped source takes over
+  std::size_t m_position = 0;
+};
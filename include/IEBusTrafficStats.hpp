@@ -0,0 +1,55 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+
+#include "IEBusDecoder.hpp"
+#include "IEBusMessage.hpp"
+
+// Running totals per (master, slave, control) stream. Memory grows with the number of distinct
+// streams on the bus, not with the length of the capture.
+class IEBusTrafficStats : public IEBusDecoderListener {
+public:
+  struct Stream {
+    std::uint16_t master = 0;
+    std::uint16_t slave = 0;
+    std::uint8_t control = 0;
+    bool hasControl = false;
+    bool broadcast = false;
+    std::uint64_t messages = 0;
+    std::uint64_t naks = 0;
+    std::uint64_t parityErrors = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t firstSample = 0;
+    std::uint64_t lastSample = 0;
+  };
+
+public:
+  auto add(IEBusMessage const& message) -> void;
+  auto clear() -> void;
+  auto onMessage(IEBusMessage const& message) -> void override;
+
+public:
+  [[nodiscard]] auto getMessageCount() const -> std::uint64_t;
+  // one CSV line per stream, ordered by master, slave and control
+  auto write(std::ostream& stream, double sampleRateHz, std::uint64_t triggerSample = 0) const -> void;
+
+private:
+  std::uint64_t m_messages = 0;
+  std::unordered_map<std::uint32_t, Stream> m_streams;
+};
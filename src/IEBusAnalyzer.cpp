@@ -16,36 +16,64 @@
 
 #include <AnalyzerChannelData.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
 
 #include "IEBusAnalyzerSettings.hpp"
 
 namespace {
 
-auto constexpr PARITY_ERROR = 1 << 0;
-auto constexpr NAK = 1 << 1;
+// how long to keep waiting for a live capture to deliver the edges the timing detection needs
+auto constexpr LIVE_DATA_WAIT = std::chrono::seconds(2);
+auto constexpr LIVE_DATA_POLL = std::chrono::milliseconds(50);
 
-auto constexpr CONTROL = 100;
-auto constexpr LENGTH = 101;
-auto constexpr DATA = 102;
-auto constexpr HEADER = 103;
+// the decoder accepts a tenth of the data bit width either side of each nominal width, a few samples
+// inside that window keep one and zero bits apart
+auto constexpr TOLERANCE_SHARE = 0.1;
+auto constexpr SAMPLES_PER_TOLERANCE = 4.0;
+
+// feeds the decoder straight from the analyzer channel, which never runs out of edges
+class ChannelEdgeSource : public IEBusEdgeSource {
+public:
+  explicit ChannelEdgeSource(AnalyzerChannelData* channel) : m_channel(channel) {
+  }
+
+public:
+  [[nodiscard]] auto getSampleNumber() -> std::uint64_t override {
+    return m_channel->GetSampleNumber();
+  }
+
+  [[nodiscard]] auto isHigh() -> bool override {
+    return m_channel->GetBitState() == BIT_HIGH;
+  }
+
+  [[nodiscard]] auto isEdgeAvailable() -> bool override {
+    return m_channel->DoMoreTransitionsExistInCurrentData();
+  }
+
+  auto advanceToNextEdge() -> bool override {
+    m_channel->AdvanceToNextEdge();
+    return true;
+  }
+
+private:
+  AnalyzerChannelData* m_channel;
+};
 
 } // namespace
 
-IEBusAnalyzer::IEBusAnalyzer() : Analyzer2(), m_settings(), m_simulationInitialized(false) {
+IEBusAnalyzer::IEBusAnalyzer() : Analyzer2(), m_settings(), m_serial(nullptr), m_simulationInitialized(false), m_sampleRateHz(0) {
   m_results = std::make_unique<IEBusAnalyzerResults>(this, &m_settings);
 
   SetAnalyzerSettings(&m_settings);
 
-  m_toleranceStart = m_settings.getStartBitWidth() / 10;
-  m_toleranceBit = m_settings.getDataBitWidth() / 10;
-  m_zeroBitLen = static_cast<U32>((static_cast<double>(m_settings.getDataBitWidth()) * 0.875));
-  m_data = 0;
-  m_flags = 0;
-
-  // mEndOfStopBitOffset = 0;
-  // mSampleRateHz = 0;
-  // mSerial = 0;
+  UseFrameV2();
 }
 
 IEBusAnalyzer::~IEBusAnalyzer() {
@@ -61,255 +89,189 @@ auto IEBusAnalyzer::SetupResults() -> void {
   m_results->AddChannelBubblesWillAppearOn(m_settings.getInputChannel());
 }
 
-[[noreturn]] auto IEBusAnalyzer::WorkerThread() -> void {
+auto IEBusAnalyzer::WorkerThread() -> void {
   m_sampleRateHz = GetSampleRate();
 
-  auto inputChannel = m_settings.getInputChannel();
+  m_inputChannel = m_settings.getInputChannel();
 
-  m_serial = GetAnalyzerChannelData(inputChannel);
+  m_serial = GetAnalyzerChannelData(m_inputChannel);
 
-  U8 data_mask = 1 << 7;
+  auto timing = IEBusTiming::fromMicroseconds(m_settings.getStartBitWidth(), m_settings.getDataBitWidth(), m_sampleRateHz);
 
-  for (;;) {
-    if (m_serial->GetBitState() == BIT_LOW) {
-      m_serial->AdvanceToNextEdge();
-    }
+  m_messagesOnly = m_settings.isMessagesOnly();
+  IEBusDissectorRegistry dissectors;
+  if (not m_settings.getDissectorFile().empty()) {
+    // already checked by the settings, a file changed since then is decoded without it
+    std::string error;
+    dissectors.loadFile(m_settings.getDissectorFile(), error);
+  }
+  m_results->setDissectors(std::move(dissectors));
+
+  IEBusEventMatcher events;
+  if (not m_settings.getEventFile().empty()) {
+    std::string error;
+    events.loadFile(m_settings.getEventFile(), error);
+  }
+  events.compile(m_sampleRateHz);
+  m_results->setEventMatcher(std::move(events));
+  m_results->setRetention(static_cast<U64>(m_settings.getRetainMessages()), static_cast<U64>(m_settings.getRetainMinutes()) * 60 * m_sampleRateHz);
+
+  ChannelEdgeSource channel(m_serial);
+  IEBusPrefetchEdgeSource source(channel);
+
+  if (m_settings.isAutoTiming()) {
+    detectTiming(source, timing);
+  }
 
-    m_data = 0;
-    int length = 0;
-
-    // flag for starting bit
-    bool found_start = false;
-    bool finished_field = false;
-    int bit_counter = 0;
-    m_startSampleNumberStart = m_serial->GetSampleNumber();
-
-    // search for the starting bit
-    while (!found_start) {
-      // go to edge of what might be the starting bit and get the sample number
-      m_serial->AdvanceToNextEdge();
-      m_startSampleNumberFinish = m_serial->GetSampleNumber();
-
-      // measure the sample and normilize the units
-      m_measureWidth = (m_startSampleNumberFinish - m_startSampleNumberStart);
-
-      // check to see if we have a starting bit
-      // if so let us continue to collect data
-      // if not we will reset the starting position
-      if ((m_measureWidth > (m_settings.getStartBitWidth() - m_toleranceStart)) && (m_measureWidth < (m_settings.getStartBitWidth() + m_toleranceStart))) {
-        m_data = 0xFFFF;
-        found_start = true;
-        m_results->AddMarker(m_startSampleNumberStart, AnalyzerResults::UpArrow, inputChannel);
-        m_results->AddMarker(m_startSampleNumberFinish, AnalyzerResults::Start, inputChannel);
-      } else {
-        m_serial->AdvanceToNextEdge();
-        m_startSampleNumberStart = m_serial->GetSampleNumber();
-      }
+  m_results->setSignalTiming(timing);
+  IEBusDecoder decoder(timing, *this);
+  decoder.run(source);
+}
+
+auto IEBusAnalyzer::detectTiming(IEBusPrefetchEdgeSource& source, IEBusTiming& timing) -> void {
+  auto const detect = [&]() -> std::optional<IEBusDetectedTiming> {
+    IEBusTimingDetector detector(source.getEdges().size());
+    auto high = source.isInitialHigh();
+    for (auto const sample : source.getEdges()) {
+      high = not high;
+      detector.addEdge(sample, high);
     }
-    update(m_startSampleNumberStart, m_data, 0, 0);
-
-    // get the header
-    m_startSampleNumberStart = m_serial->GetSampleNumber();
-    m_results->AddMarker(m_serial->GetSampleNumber(), AnalyzerResults::Dot, inputChannel);
-    m_serial->AdvanceToNextEdge();
-    m_startSampleNumberFinish = m_serial->GetSampleNumber();
-    m_measureWidth = (m_startSampleNumberFinish - m_startSampleNumberStart);
-    if ((m_measureWidth > ((m_settings.getDataBitWidth() / 2) - m_toleranceBit)) && (m_measureWidth < ((m_settings.getDataBitWidth() / 2) + m_toleranceBit))) {
-      m_results->AddMarker(m_serial->GetSampleNumber(), AnalyzerResults::One, inputChannel);
-      m_data = 1;
-    } else {
-      m_results->AddMarker(m_serial->GetSampleNumber(), AnalyzerResults::Zero, inputChannel);
-      m_data = 0;
+    return detector.detect();
+  };
+
+  source.prefetch(IEBusTimingDetector::DEFAULT_EDGES);
+  auto detected = detect();
+
+  // a live capture may not have delivered enough edges yet, detect again as more arrive until it stalls
+  auto lastData = std::chrono::steady_clock::now();
+  while (not detected and source.getEdges().size() < IEBusTimingDetector::DEFAULT_EDGES and std::chrono::steady_clock::now() - lastData < LIVE_DATA_WAIT) {
+    CheckIfThreadShouldExit();
+    std::this_thread::sleep_for(LIVE_DATA_POLL);
+
+    auto const count = source.getEdges().size();
+    source.prefetch(IEBusTimingDetector::DEFAULT_EDGES);
+    if (source.getEdges().size() > count) {
+      lastData = std::chrono::steady_clock::now();
+      detected = detect();
     }
-    update(m_startSampleNumberStart, m_data, HEADER, 0);
+  }
 
-    // get the master address
-    if (not getAddress(true)) {
-      continue;
-    }
+  auto const edges = source.getEdges();
+  if (edges.empty()) {
+    return;
+  }
 
-    // get the slave address
-    if (not getAddress(false)) {
-      continue;
-    }
+  if (detected) {
+    timing = detected->timing;
+  }
 
-    // get control
-    getData(CONTROL);
-    // get length
-    length = getData(LENGTH);
-    while (length > 0) {
-      getData(DATA);
-      length--;
-    }
+  // report what the decoder runs with as the first row of the data table
+  auto const samplesPerUs = static_cast<double>(m_sampleRateHz) / 1000000.0;
+
+  FrameV2 frameV2;
+  frameV2.AddBoolean("detected", detected.has_value());
+  frameV2.AddDouble("start_bit_us", static_cast<double>(timing.startBitWidth) / samplesPerUs);
+  frameV2.AddDouble("bit_us", static_cast<double>(timing.dataBitWidth) / samplesPerUs);
+  if (detected) {
+    frameV2.AddDouble("one_us", detected->oneWidth / samplesPerUs);
+    frameV2.AddDouble("zero_us", detected->zeroWidth / samplesPerUs);
+    frameV2.AddInteger("pulses", static_cast<S64>(detected->pulses));
   }
+  m_results->AddFrameV2(frameV2, "timing", edges.front(), edges.front());
+  m_results->CommitResults();
 }
 
-auto IEBusAnalyzer::update(U64 startingSample, U64& data1, U8 type, U8 flags) -> void {
+auto IEBusAnalyzer::onMarker(std::uint64_t sample, Marker marker) -> void {
+  if (m_messagesOnly) {
+    return;
+  }
+
+  switch (marker) {
+  case Marker::UpArrow:
+    m_results->AddMarker(sample, AnalyzerResults::UpArrow, m_inputChannel);
+    break;
+  case Marker::Start:
+    m_results->AddMarker(sample, AnalyzerResults::Start, m_inputChannel);
+    break;
+  case Marker::Dot:
+    m_results->AddMarker(sample, AnalyzerResults::Dot, m_inputChannel);
+    break;
+  case Marker::One:
+    m_results->AddMarker(sample, AnalyzerResults::One, m_inputChannel);
+    break;
+  case Marker::Zero:
+    m_results->AddMarker(sample, AnalyzerResults::Zero, m_inputChannel);
+    break;
+  case Marker::ErrorX:
+    m_results->AddMarker(sample, AnalyzerResults::ErrorX, m_inputChannel);
+    break;
+  }
+}
+
+auto IEBusAnalyzer::onField(IEBusField const& field) -> void {
+  if (m_messagesOnly) {
+    return;
+  }
+
   Frame f;
-  f.mData1 = U32(data1);
-  f.mData2 = type;
-  f.mFlags = flags;
-  f.mStartingSampleInclusive = startingSample;
-  f.mEndingSampleInclusive = m_serial->GetSampleNumber();
+  f.mData1 = U32(field.value);
+  f.mData2 = field.type;
+  f.mFlags = field.flags ? field.flags | DISPLAY_AS_ERROR_FLAG : 0;
+  f.mStartingSampleInclusive = field.startSample;
+  f.mEndingSampleInclusive = field.endSample;
 
   m_results->AddFrame(f);
   m_results->CommitResults();
 
   ReportProgress(f.mEndingSampleInclusive);
-
-  // move to next rising edge
-  m_serial->AdvanceToNextEdge();
-  data1 = 0;
 }
 
-auto IEBusAnalyzer::parity(U16 data) -> U8 {
-  int parity = 0;
-  for (int x = 0; x < 8; x++) {
-    if (data & 1 << x)
-      parity++;
-  }
-  if (parity % 2)
-    return 1;
-  else
-    return 0;
-}
+auto IEBusAnalyzer::onMessage(IEBusMessage const& message) -> void {
+  auto const index = m_results->addMessage(message);
 
-auto IEBusAnalyzer::getAddress(bool master) -> bool {
-  U16 mask = 1 << 11;
-  m_data = 0;
-  m_flags = 0;
-  m_startSampleNumberStart = m_serial->GetSampleNumber();
-  m_startBitNumberStart = m_startSampleNumberStart;
-
-  auto inputChannel = m_settings.getInputChannel();
-
-  int i = 0;
-  while (i < 12) {
-    m_results->AddMarker(m_startBitNumberStart, AnalyzerResults::Dot, inputChannel);
-    m_serial->AdvanceToNextEdge();
-    m_startSampleNumberFinish = m_serial->GetSampleNumber();
-    m_measureWidth = (m_startSampleNumberFinish - m_startBitNumberStart);
-    if ((m_measureWidth > (m_settings.getDataBitWidth() / 2 - m_toleranceBit)) && (m_measureWidth < ((m_settings.getDataBitWidth() / 2) + m_toleranceBit))) {
-      m_results->AddMarker(m_serial->GetSampleNumber(), AnalyzerResults::One, inputChannel);
-      m_data |= mask;
-    } else if ((m_measureWidth > (m_zeroBitLen - m_toleranceBit)) && (m_measureWidth < (m_zeroBitLen + m_toleranceBit))) {
-      m_results->AddMarker(m_serial->GetSampleNumber(), AnalyzerResults::Zero, inputChannel);
-    } else {
-      return false;
-    }
-    i++;
-    if (i < 12) {
-      m_serial->AdvanceToNextEdge();
-      m_startBitNumberStart = m_serial->GetSampleNumber();
-      mask = mask >> 1;
-    }
-    // get the parity
-    else {
-      m_serial->AdvanceToNextEdge();
-      m_startBitNumberStart = m_serial->GetSampleNumber();
-      m_results->AddMarker(m_serial->GetSampleNumber(), AnalyzerResults::Dot, inputChannel);
-      m_serial->AdvanceToNextEdge();
-      m_startSampleNumberFinish = m_serial->GetSampleNumber();
-      m_measureWidth = (m_startSampleNumberFinish - m_startBitNumberStart);
-      if (m_measureWidth > (m_settings.getDataBitWidth() / 2 - m_toleranceBit) && m_measureWidth < (m_settings.getDataBitWidth() / 2 + m_toleranceBit)) {
-        m_results->AddMarker(m_serial->GetSampleNumber(), AnalyzerResults::One, inputChannel);
-        m_flags = 1;
-      } else if ((m_measureWidth > (m_zeroBitLen - m_toleranceBit)) && (m_measureWidth < (m_zeroBitLen + m_toleranceBit))) {
-        m_results->AddMarker(m_serial->GetSampleNumber(), AnalyzerResults::Zero, inputChannel);
-        m_flags = 0;
-      } else
-        return false;
-      m_flags = m_flags & parity(static_cast<U16>(m_data));
-    }
+  FrameV2 frameV2;
+  frameV2.AddInteger("master", message.master);
+  frameV2.AddInteger("slave", message.slave);
+  frameV2.AddBoolean("broadcast", message.isBroadcast());
+  if (message.hasControl) {
+    frameV2.AddInteger("control", message.control);
+    frameV2.AddInteger("length", message.length);
   }
-  // if slave address we should expect a slave ack
-  if (not master) {
-    m_serial->AdvanceToNextEdge();
-    m_startBitNumberStart = m_serial->GetSampleNumber();
-    m_results->AddMarker(m_serial->GetSampleNumber(), AnalyzerResults::Dot, inputChannel);
-    m_serial->AdvanceToNextEdge();
-    m_startSampleNumberFinish = m_serial->GetSampleNumber();
-    m_measureWidth = (m_startSampleNumberFinish - m_startBitNumberStart);
-    if (m_measureWidth > (m_settings.getDataBitWidth() / 2 - m_toleranceBit) && m_measureWidth < (m_settings.getDataBitWidth() / 2 + m_toleranceBit)) {
-      m_results->AddMarker(m_serial->GetSampleNumber(), AnalyzerResults::One, inputChannel);
-      m_flags = NAK;
-    } else if ((m_measureWidth > (m_zeroBitLen - m_toleranceBit)) && (m_measureWidth < (m_zeroBitLen + m_toleranceBit))) {
-      m_results->AddMarker(m_serial->GetSampleNumber(), AnalyzerResults::Zero, inputChannel);
-    } else
-      return false;
+  frameV2.AddByteArray("data", message.data.data(), message.data.size());
+  frameV2.AddBoolean("nak", (message.flags & IEBusFlag::NAK) != 0);
+  frameV2.AddBoolean("parity_error", (message.flags & IEBusFlag::PARITY_ERROR) != 0);
+  if (auto const command = m_results->getDissectors().find(message)) {
+    IEBusDissectorRegistry::formatFields(*command, message, m_fields);
+    frameV2.AddString("command", command->name.c_str());
+    frameV2.AddString("fields", m_fields.c_str());
   }
-  update(m_startSampleNumberStart, m_data, master, 0 /*flags*/); // return flags for NACK
-  return (m_flags != NAK);
-}
 
-auto IEBusAnalyzer::getData(U8 dataType) -> int {
-  U8 numBits = 8;
-  U16 mask = 1 << 7;
-  if (dataType == CONTROL) {
-    numBits = 4;
-    mask = 1 << 3;
-  }
-  m_data = 0;
-  m_flags = 0;
-  m_startSampleNumberStart = m_serial->GetSampleNumber();
-  m_startBitNumberStart = m_startSampleNumberStart;
-
-  auto inputChannel = m_settings.getInputChannel();
-
-  int i = 0;
-  while (i < numBits) {
-    m_results->AddMarker(m_startBitNumberStart, AnalyzerResults::Dot, inputChannel);
-    m_serial->AdvanceToNextEdge();
-    m_startSampleNumberFinish = m_serial->GetSampleNumber();
-    m_measureWidth = (m_startSampleNumberFinish - m_startBitNumberStart);
-    if (m_measureWidth > (m_settings.getDataBitWidth() / 2 - m_toleranceBit) && m_measureWidth < (m_settings.getDataBitWidth() / 2 + m_toleranceBit)) {
-      m_results->AddMarker(m_serial->GetSampleNumber(), AnalyzerResults::One, inputChannel);
-      m_data |= mask;
-    } else {
-      m_results->AddMarker(m_serial->GetSampleNumber(), AnalyzerResults::Zero, inputChannel);
-    }
-    i++;
-    if (i < numBits) {
-      m_serial->AdvanceToNextEdge();
-      m_startBitNumberStart = m_serial->GetSampleNumber();
-      mask = mask >> 1;
-    }
-    // get the parity
-    else {
-      m_serial->AdvanceToNextEdge();
-      m_startBitNumberStart = m_serial->GetSampleNumber();
-      m_results->AddMarker(m_serial->GetSampleNumber(), AnalyzerResults::Dot, inputChannel);
-      m_serial->AdvanceToNextEdge();
-      m_startSampleNumberFinish = m_serial->GetSampleNumber();
-      m_measureWidth = (m_startSampleNumberFinish - m_startBitNumberStart);
-      if (m_measureWidth > (m_settings.getDataBitWidth() / 2 - m_toleranceBit) && m_measureWidth < (m_settings.getDataBitWidth() / 2 + m_toleranceBit)) {
-        m_results->AddMarker(m_serial->GetSampleNumber(), AnalyzerResults::One, inputChannel);
-        // flags = 1;
-      } else {
-        m_results->AddMarker(m_serial->GetSampleNumber(), AnalyzerResults::Zero, inputChannel);
-        // flags = 0;
-      }
-      // flags = flags & parity(data);
+  // one marker per flagged message, at its end to keep markers in sample order; the rule names go to the data table
+  m_results->matchEvents(index, message, m_eventHits);
+  if (not m_eventHits.empty()) {
+    m_eventNames.clear();
+    for (auto const rule : m_eventHits) {
+      m_eventNames += m_eventNames.empty() ? "" : ", ";
+      m_eventNames += m_results->getEventRule(rule).name;
     }
+    frameV2.AddString("events", m_eventNames.c_str());
+    m_results->AddMarker(message.endSample, AnalyzerResults::Square, m_inputChannel);
   }
+  m_results->AddFrameV2(frameV2, "message", message.startSample, message.endSample);
 
-  // we should always expect a ACK
-  m_serial->AdvanceToNextEdge();
-  m_startBitNumberStart = m_serial->GetSampleNumber();
-  m_results->AddMarker(m_serial->GetSampleNumber(), AnalyzerResults::Dot, inputChannel);
-  m_serial->AdvanceToNextEdge();
-  m_startSampleNumberFinish = m_serial->GetSampleNumber();
-  m_measureWidth = (m_startSampleNumberFinish - m_startBitNumberStart);
-  if (m_measureWidth > (m_settings.getDataBitWidth() / 2 - m_toleranceBit) && m_measureWidth < (m_settings.getDataBitWidth() / 2 + m_toleranceBit)) {
-    m_results->AddMarker(m_serial->GetSampleNumber(), AnalyzerResults::One, inputChannel);
-    m_flags = m_flags | 2;
-  } else {
-    m_results->AddMarker(m_serial->GetSampleNumber(), AnalyzerResults::Zero, inputChannel);
+  // without field frames the message itself carries the bubble
+  if (m_messagesOnly) {
+    m_results->AddFrame(IEBusAnalyzerResults::makeMessageFrame(index, message));
   }
-  // data gets reset in update, so save a copy for returning
-  U8 tempData = static_cast<U8>(m_data);
-  update(m_startSampleNumberStart, m_data, dataType, m_flags);
-  return tempData;
+
+  m_results->CommitResults();
+
+  ReportProgress(message.endSample);
+}
+
+auto IEBusAnalyzer::onPulse(IEBusPulse const& pulse) -> void {
+  // collected in every mode, the report doesn't depend on frames
+  m_results->addPulse(pulse);
 }
 
 auto IEBusAnalyzer::GenerateSimulationData(U64 minimumSampleIndex, U32 sampleRate, SimulationChannelDescriptor** simulationChannels) -> U32 {
@@ -323,7 +285,8 @@ auto IEBusAnalyzer::GenerateSimulationData(U64 minimumSampleIndex, U32 sampleRat
 }
 
 auto IEBusAnalyzer::GetMinimumSampleRateHz() -> U32 {
-  return m_settings.getStartBitWidth() * 4;
+  auto const toleranceUs = std::max(1, m_settings.getDataBitWidth()) * TOLERANCE_SHARE;
+  return static_cast<U32>(std::ceil(SAMPLES_PER_TOLERANCE * 1000000.0 / toleranceUs));
 }
 
 auto IEBusAnalyzer::GetAnalyzerName() const -> char const* {
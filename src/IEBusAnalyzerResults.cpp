@@ -15,37 +15,25 @@
 #include "IEBusAnalyzerResults.hpp"
 
 #include <AnalyzerHelpers.h>
-#include <array>
 #include <fstream>
 #include <iostream>
+#include <utility>
 
 #include "IEBusAnalyzer.hpp"
 #include "IEBusAnalyzerSettings.hpp"
+#include "IEBusDeltaWriter.hpp"
+#include "IEBusEventWriter.hpp"
+#include "IEBusMessageWriter.hpp"
 
 namespace {
 
-auto constexpr PARITY_ERROR = 1 << 0;
-auto constexpr NAK = 1 << 1;
-
-auto constexpr CONTROL = 100;
-auto constexpr LENGTH = 101;
-auto constexpr DATA = 102;
-auto constexpr HEADER = 103;
-
-auto constexpr NUMBER_STRINGS = 128;
-
-// this is the control bit functions
-// this likely needs to move to results
-#define READSLAVESTATUS 0x0
-#define READANDLOCK 0x3
-#define READLOCKLOWER 0x4
-#define READLOCKUPPER 0x5
-#define READANDUNLOCK 0x6
-#define READDATA 0x7
-#define WRITEANDLOCKCOMMAND 0xA
-#define WRITEANDLOCKDATA 0xB
-// #define WRITEANDLOCKCOMMAND 	0xE
-#define WRITEDATA 0xF
+// Frame::mData1 of message frames: store index, then the addresses and control code
+auto constexpr MESSAGE_INDEX_MASK = U64{0xFFFFFFFF};
+auto constexpr MESSAGE_MASTER_SHIFT = 32;
+auto constexpr MESSAGE_SLAVE_SHIFT = 44;
+auto constexpr MESSAGE_CONTROL_SHIFT = 56;
+auto constexpr MESSAGE_HEADER_SHIFT = 60;
+auto constexpr MESSAGE_HAS_CONTROL = U64{1} << 61;
 
 } // namespace
 
@@ -55,22 +43,129 @@ IEBusAnalyzerResults::IEBusAnalyzerResults(IEBusAnalyzer* analyzer, IEBusAnalyze
 auto IEBusAnalyzerResults::GenerateBubbleText(U64 frameIndex, Channel& channel, DisplayBase displayBase) -> void {
   ClearResultStrings();
 
-  Frame frame = GetFrame(frameIndex);
+  auto const frame = GetFrame(frameIndex);
 
-  auto numberStrings = std::array<char, NUMBER_STRINGS>();
+  IEBusResultFormatter::Strings strings;
+  formatFrame(frame, displayBase, strings);
 
-  AnalyzerHelpers::GetNumberString(frame.mData1, displayBase, 8, numberStrings.data(), NUMBER_STRINGS);
+  // shortest first, the bubble shows the longest one that fits
+  AddResultString(strings.shortText.data());
+  AddResultString(strings.mediumText.data());
+  AddResultString(strings.longText.data());
+}
 
-  if (frame.mFlags) {
-    if (frame.mFlags & NAK) {
-      AddResultString("NAK");
-    }
+auto IEBusAnalyzerResults::GenerateExportFile(const char* file, DisplayBase display_base, U32 export_type_user_id) -> void {
+  if (export_type_user_id == IEBusAnalyzerSettings::EXPORT_FRAMES) {
+    exportFrames(file, display_base);
+  } else if (export_type_user_id == IEBusAnalyzerSettings::EXPORT_STATISTICS) {
+    exportStatistics(file);
+  } else if (export_type_user_id == IEBusAnalyzerSettings::EXPORT_EVENTS) {
+    exportEvents(file);
+  } else if (export_type_user_id == IEBusAnalyzerSettings::EXPORT_SIGNAL_QUALITY) {
+    exportSignalQuality(file);
   } else {
-    AddResultString(numberStrings.data());
+    exportMessages(file, export_type_user_id);
   }
 }
 
-auto IEBusAnalyzerResults::GenerateExportFile(const char* file, DisplayBase display_base, U32 export_type_user_id) -> void {
+auto IEBusAnalyzerResults::setDissectors(IEBusDissectorRegistry dissectors) -> void {
+  m_dissectors = std::move(dissectors);
+}
+
+auto IEBusAnalyzerResults::getDissectors() const -> IEBusDissectorRegistry const& {
+  return m_dissectors;
+}
+
+auto IEBusAnalyzerResults::setEventMatcher(IEBusEventMatcher matcher) -> void {
+  std::scoped_lock lock(m_messagesMutex);
+  m_eventMatcher = std::move(matcher);
+}
+
+auto IEBusAnalyzerResults::matchEvents(U64 index, IEBusMessage const& message, std::vector<std::uint32_t>& hits) -> void {
+  std::scoped_lock lock(m_messagesMutex);
+  m_eventMatcher.match(message, hits);
+  for (auto const rule : hits) {
+    m_events.push_back({rule, index});
+  }
+}
+
+auto IEBusAnalyzerResults::getEventRule(std::uint32_t id) const -> IEBusEventRule const& {
+  // rules never change once decoding started
+  return m_eventMatcher.getRule(id);
+}
+
+auto IEBusAnalyzerResults::setRetention(U64 maxMessages, U64 maxSamples) -> void {
+  std::scoped_lock lock(m_messagesMutex);
+  m_messages.setRetention(maxMessages, maxSamples);
+}
+
+auto IEBusAnalyzerResults::addMessage(IEBusMessage const& message) -> U64 {
+  std::scoped_lock lock(m_messagesMutex);
+  m_stats.add(message);
+  m_signalQuality.onMessage(message);
+  auto const index = m_messages.add(message);
+
+  // drop the hits of evicted messages under the same lock, an export must never see one
+  while (not m_events.empty() and m_events.front().message < m_messages.getFirstIndex()) {
+    m_events.pop_front();
+  }
+
+  return index;
+}
+
+auto IEBusAnalyzerResults::setSignalTiming(IEBusTiming const& timing) -> void {
+  std::scoped_lock lock(m_messagesMutex);
+  m_signalQuality.setTiming(timing);
+}
+
+auto IEBusAnalyzerResults::addPulse(IEBusPulse const& pulse) -> void {
+  // only touches the pending message, which the export never reads
+  m_signalQuality.onPulse(pulse);
+}
+
+auto IEBusAnalyzerResults::getMessage(U64 index, IEBusMessage& message) -> bool {
+  std::scoped_lock lock(m_messagesMutex);
+  if (not m_messages.contains(index)) {
+    return false;
+  }
+
+  m_messages.get(index, message);
+  return true;
+}
+
+auto IEBusAnalyzerResults::makeMessageFrame(U64 index, IEBusMessage const& message) -> Frame {
+  Frame f;
+  f.mData1 = (index & MESSAGE_INDEX_MASK) | (U64{message.master} << MESSAGE_MASTER_SHIFT) | (U64{message.slave} << MESSAGE_SLAVE_SHIFT) |
+             (U64{message.control} << MESSAGE_CONTROL_SHIFT) | (U64{message.header} << MESSAGE_HEADER_SHIFT) | (message.hasControl ? MESSAGE_HAS_CONTROL : 0);
+  f.mData2 = IEBusFieldType::MESSAGE;
+  f.mType = message.length;
+  f.mFlags = message.flags ? message.flags | DISPLAY_AS_ERROR_FLAG : 0;
+  f.mStartingSampleInclusive = message.startSample;
+  f.mEndingSampleInclusive = message.endSample;
+  return f;
+}
+
+auto IEBusAnalyzerResults::formatFrame(Frame const& frame, DisplayBase displayBase, IEBusResultFormatter::Strings& strings) -> void {
+  if (frame.mData2 != IEBusFieldType::MESSAGE) {
+    m_formatter.format(frame, displayBase, strings);
+    return;
+  }
+
+  IEBusMessage message;
+  if (not getMessage(frame.mData1 & MESSAGE_INDEX_MASK, message)) {
+    // dropped by retention, show what the frame itself remembers
+    message.master = static_cast<std::uint16_t>((frame.mData1 >> MESSAGE_MASTER_SHIFT) & 0xFFF);
+    message.slave = static_cast<std::uint16_t>((frame.mData1 >> MESSAGE_SLAVE_SHIFT) & 0xFFF);
+    message.control = static_cast<std::uint8_t>((frame.mData1 >> MESSAGE_CONTROL_SHIFT) & 0xF);
+    message.header = static_cast<std::uint8_t>((frame.mData1 >> MESSAGE_HEADER_SHIFT) & 0x1);
+    message.hasControl = (frame.mData1 & MESSAGE_HAS_CONTROL) != 0;
+    message.length = frame.mType;
+    message.flags = frame.mFlags & (IEBusFlag::PARITY_ERROR | IEBusFlag::NAK);
+  }
+  m_formatter.formatMessage(message, displayBase, strings, m_dissectors.find(message));
+}
+
+auto IEBusAnalyzerResults::exportFrames(const char* file, DisplayBase display_base) -> void {
   std::ofstream fileStream(file, std::ios::out);
 
   auto const triggerSample = m_analyzer->GetTriggerSample();
@@ -79,6 +174,7 @@ auto IEBusAnalyzerResults::GenerateExportFile(const char* file, DisplayBase disp
   fileStream << "Time [s],Value" << std::endl;
 
   auto const numFrames = GetNumFrames();
+  IEBusResultFormatter::Strings strings;
 
   for (U32 i = 0; i < numFrames; i++) {
     Frame frame = GetFrame(i);
@@ -86,29 +182,29 @@ auto IEBusAnalyzerResults::GenerateExportFile(const char* file, DisplayBase disp
     char time_str[128];
     AnalyzerHelpers::GetTimeString(frame.mStartingSampleInclusive, triggerSample, sampleRate, time_str, 128);
 
-    if (frame.mFlags) {
-      if (frame.mFlags & NAK) {
-        fileStream << time_str << "," << "NAK" << std::endl;
-      }
-    } else if (frame.mData1 == 0xFFFF) {
+    if (frame.mData2 == IEBusFieldType::MESSAGE) {
+      formatFrame(frame, display_base, strings);
+      fileStream << time_str << ", MESSAGE: " << strings.longText.data() << std::endl;
+    } else if (frame.mData2 == IEBusFieldType::START) {
       fileStream << std::endl << "=======================================" << std::endl;
       fileStream << time_str << "," << " START" << std::endl;
     } else {
-      char number_str[128];
-      AnalyzerHelpers::GetNumberString(frame.mData1, display_base, 8, number_str, 128);
-      if (frame.mData2 == CONTROL)
-        fileStream << time_str << ", Control: " << number_str << std::endl;
-      else if (frame.mData2 == LENGTH) {
-        fileStream << time_str << ", Frame Length: " << number_str << std::endl;
+      auto const number_str = m_formatter.getNumberString(frame.mData1, static_cast<U8>(frame.mData2), display_base);
+      auto const status = (frame.mFlags & IEBusFlag::PARITY_ERROR) ? ((frame.mFlags & IEBusFlag::NAK) ? " PARITY ERROR NAK" : " PARITY ERROR")
+                                                                    : ((frame.mFlags & IEBusFlag::NAK) ? " NAK" : "");
+      if (frame.mData2 == IEBusFieldType::CONTROL)
+        fileStream << time_str << ", Control: " << number_str << status << std::endl;
+      else if (frame.mData2 == IEBusFieldType::LENGTH) {
+        fileStream << time_str << ", Frame Length: " << number_str << status << std::endl;
         fileStream << time_str << ", DATA: ";
-      } else if (frame.mData2 == DATA)
-        fileStream << "," << number_str;
-      else if (frame.mData2 == HEADER)
+      } else if (frame.mData2 == IEBusFieldType::DATA)
+        fileStream << "," << number_str << status;
+      else if (frame.mData2 == IEBusFieldType::HEADER)
         fileStream << time_str << ", HEADER: " << number_str << std::endl;
-      else if (frame.mData2 == 0)
-        fileStream << time_str << ", SLAVE ADDRESS: " << number_str << std::endl;
+      else if (frame.mData2 == IEBusFieldType::SLAVE)
+        fileStream << time_str << ", SLAVE ADDRESS: " << number_str << status << std::endl;
       else
-        fileStream << time_str << ", MASTER ADDRESS" << number_str << std::endl;
+        fileStream << time_str << ", MASTER ADDRESS" << number_str << status << std::endl;
     }
 
     if (UpdateExportProgressAndCheckForCancel(i, numFrames)) {
@@ -125,9 +221,12 @@ auto IEBusAnalyzerResults::GenerateExportFile(const char* file, DisplayBase disp
 
     char time_str[128];
     AnalyzerHelpers::GetTimeString(frame.mStartingSampleInclusive, triggerSample, sampleRate, time_str, 128);
-    char number_str[128];
-    AnalyzerHelpers::GetNumberString(frame.mData1, Hexadecimal, 8, number_str, 128);
-    fileStream << number_str << std::endl;
+    // message frames only hold a store index and the addresses, their bytes are in the section above
+    if (frame.mData2 != IEBusFieldType::MESSAGE) {
+      char number_str[128];
+      AnalyzerHelpers::GetNumberString(frame.mData1, Hexadecimal, 8, number_str, 128);
+      fileStream << number_str << std::endl;
+    }
 
     if (UpdateExportProgressAndCheckForCancel(i, numFrames)) {
       fileStream.close();
@@ -138,14 +237,96 @@ auto IEBusAnalyzerResults::GenerateExportFile(const char* file, DisplayBase disp
   fileStream.close();
 }
 
+auto IEBusAnalyzerResults::exportMessages(const char* file, U32 export_type_user_id) -> void {
+  std::ofstream fileStream(file, std::ios::out | std::ios::binary);
+
+  std::scoped_lock lock(m_messagesMutex);
+
+  // only what the retention window still holds, the statistics export covers the rest
+  auto const firstMessage = m_messages.getFirstIndex();
+  auto const numMessages = m_messages.size();
+  IEBusMessage message;
+
+  if (export_type_user_id == IEBusAnalyzerSettings::EXPORT_MESSAGES_DELTA) {
+    IEBusDeltaWriter writer(fileStream, m_analyzer->GetSampleRate(), m_analyzer->GetTriggerSample());
+
+    for (U64 i = 0; i < numMessages; i++) {
+      m_messages.get(firstMessage + i, message);
+      writer.write(message, m_messages.getRecord(firstMessage + i).id);
+
+      if (UpdateExportProgressAndCheckForCancel(i, numMessages)) {
+        fileStream.close();
+        return;
+      }
+    }
+
+    writer.finish();
+    fileStream.close();
+    return;
+  }
+
+  auto const format = export_type_user_id == IEBusAnalyzerSettings::EXPORT_MESSAGES_BINARY ? IEBusMessageWriter::Format::Binary : IEBusMessageWriter::Format::Csv;
+  IEBusMessageWriter writer(fileStream, format, m_analyzer->GetSampleRate(), m_analyzer->GetTriggerSample(), &m_dissectors);
+
+  for (U64 i = 0; i < numMessages; i++) {
+    m_messages.get(firstMessage + i, message);
+    writer.write(message);
+
+    if (UpdateExportProgressAndCheckForCancel(i, numMessages)) {
+      break;
+    }
+  }
+
+  fileStream.close();
+}
+
+auto IEBusAnalyzerResults::exportStatistics(const char* file) -> void {
+  std::ofstream fileStream(file, std::ios::out | std::ios::binary);
+
+  std::scoped_lock lock(m_messagesMutex);
+  m_stats.write(fileStream, m_analyzer->GetSampleRate(), m_analyzer->GetTriggerSample());
+
+  fileStream.close();
+}
+
+auto IEBusAnalyzerResults::exportSignalQuality(const char* file) -> void {
+  std::ofstream fileStream(file, std::ios::out | std::ios::binary);
+
+  std::scoped_lock lock(m_messagesMutex);
+  m_signalQuality.write(fileStream, m_analyzer->GetSampleRate());
+
+  fileStream.close();
+}
+
+auto IEBusAnalyzerResults::exportEvents(const char* file) -> void {
+  std::ofstream fileStream(file, std::ios::out | std::ios::binary);
+
+  std::scoped_lock lock(m_messagesMutex);
+  IEBusEventWriter writer(fileStream, m_eventMatcher, m_analyzer->GetSampleRate(), m_analyzer->GetTriggerSample());
+  IEBusMessage message;
+
+  // hits are evicted in the same critical section as their messages, so every one still resolves
+  auto const numEvents = m_events.size();
+  for (U64 i = 0; i < numEvents; i++) {
+    m_messages.get(m_events[i].message, message);
+    writer.write(m_events[i].rule, message);
+
+    if (UpdateExportProgressAndCheckForCancel(i, numEvents)) {
+      break;
+    }
+  }
+
+  fileStream.close();
+}
+
 auto IEBusAnalyzerResults::GenerateFrameTabularText(U64 frame_index, DisplayBase display_base) -> void {
 #ifdef SUPPORTS_PROTOCOL_SEARCH
-  Frame frame = GetFrame(frame_index);
+  auto const frame = GetFrame(frame_index);
   ClearResultStrings();
 
-  char number_str[128];
-  AnalyzerHelpers::GetNumberString(frame.mData1, display_base, 8, number_str, 128);
-  AddResultString(number_str);
+  IEBusResultFormatter::Strings strings;
+  formatFrame(frame, display_base, strings);
+  AddResultString(strings.longText.data());
 #endif
 }
 
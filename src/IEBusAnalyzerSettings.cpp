@@ -16,6 +16,9 @@
 
 #include <AnalyzerHelpers.h>
 
+#include "IEBusDissector.hpp"
+#include "IEBusEventMatcher.hpp"
+
 namespace {
 
 auto constexpr START_BIT_TOTAL_US = 190;
@@ -30,7 +33,8 @@ auto constexpr DATA_BIT_1_LOW_US  = DATA_BIT_TOTAL_US - DATA_BIT_1_HIGH_US;
 
 } // namespace
 
-IEBusAnalyzerSettings::IEBusAnalyzerSettings() : m_dataBitWidth(DATA_BIT_TOTAL_US), m_startBitWidth(START_BIT_HIGH_US), m_inputChannel(UNDEFINED_CHANNEL) {
+IEBusAnalyzerSettings::IEBusAnalyzerSettings() : m_dataBitWidth(DATA_BIT_TOTAL_US), m_startBitWidth(START_BIT_HIGH_US), m_inputChannel(UNDEFINED_CHANNEL), m_messagesOnly(false), m_autoTiming(true),
+      m_retainMessages(0), m_retainMinutes(0) {
   m_dataBitWidthInterface.SetTitleAndTooltip("Bit Width (uS)", "Specify the bit width in uS");
   m_dataBitWidthInterface.SetMax(6000000);
   m_dataBitWidthInterface.SetMin(1);
@@ -44,13 +48,61 @@ IEBusAnalyzerSettings::IEBusAnalyzerSettings() : m_dataBitWidth(DATA_BIT_TOTAL_U
   m_startBitWidthInterface.SetMin(1);
   m_startBitWidthInterface.SetInteger(m_startBitWidth);
 
+  m_messagesOnlyInterface.SetTitleAndTooltip("Messages only", "One result per message, without field bubbles and bit markers. Keeps long captures small");
+  m_messagesOnlyInterface.SetValue(m_messagesOnly);
+
+  m_autoTimingInterface.SetTitleAndTooltip("Auto-detect bit timing", "Measure the bit widths from the first edges of the capture, the widths above are used if that fails");
+  m_autoTimingInterface.SetValue(m_autoTiming);
+
+  m_retainMessagesInterface.SetTitleAndTooltip("Keep last N messages", "Only bounds the plugin's message and event exports, Logic 2 keeps every frame; 0 keeps all");
+  m_retainMessagesInterface.SetMax(100000000);
+  m_retainMessagesInterface.SetMin(0);
+  m_retainMessagesInterface.SetInteger(m_retainMessages);
+
+  m_retainMinutesInterface.SetTitleAndTooltip("Keep last N minutes", "Only bounds the plugin's message and event exports, Logic 2 keeps every frame; 0 keeps all");
+  m_retainMinutesInterface.SetMax(100000);
+  m_retainMinutesInterface.SetMin(0);
+  m_retainMinutesInterface.SetInteger(m_retainMinutes);
+
+  m_dissectorFileInterface.SetTitleAndTooltip("Dissector definitions", "Optional file of application-layer commands, one per line: <slave|*> <control> <prefix|-> <name> [<field>:<offset>]...");
+  m_dissectorFileInterface.SetTextType(AnalyzerSettingInterfaceText::FilePath);
+  m_dissectorFileInterface.SetText(m_dissectorFile.c_str());
+
+  m_eventFileInterface.SetTitleAndTooltip("Event rules", "Optional file of rules flagging messages with a marker, one per line: <name> [master=..] [slave=..] [control=..] [data=..] [nak] [rate=..]");
+  m_eventFileInterface.SetTextType(AnalyzerSettingInterfaceText::FilePath);
+  m_eventFileInterface.SetText(m_eventFile.c_str());
+
   AddInterface(&m_dataBitWidthInterface);
   AddInterface(&m_inputChannelInterface);
   AddInterface(&m_startBitWidthInterface);
+  AddInterface(&m_messagesOnlyInterface);
+  AddInterface(&m_autoTimingInterface);
+  AddInterface(&m_retainMessagesInterface);
+  AddInterface(&m_retainMinutesInterface);
+  AddInterface(&m_dissectorFileInterface);
+  AddInterface(&m_eventFileInterface);
+
+  AddExportOption(EXPORT_FRAMES, "Export as text/csv file");
+  AddExportExtension(EXPORT_FRAMES, "text", "txt");
+  AddExportExtension(EXPORT_FRAMES, "csv", "csv");
 
-  AddExportOption(0, "Export as text/csv file");
-  AddExportExtension(0, "text", "txt");
-  AddExportExtension(0, "csv", "csv");
+  AddExportOption(EXPORT_MESSAGES_CSV, "Export messages as csv file");
+  AddExportExtension(EXPORT_MESSAGES_CSV, "csv", "csv");
+
+  AddExportOption(EXPORT_MESSAGES_BINARY, "Export messages as binary file");
+  AddExportExtension(EXPORT_MESSAGES_BINARY, "binary", "iebus");
+
+  AddExportOption(EXPORT_MESSAGES_DELTA, "Export message changes as csv file (repeats collapsed)");
+  AddExportExtension(EXPORT_MESSAGES_DELTA, "csv", "csv");
+
+  AddExportOption(EXPORT_STATISTICS, "Export traffic statistics as csv file");
+  AddExportExtension(EXPORT_STATISTICS, "csv", "csv");
+
+  AddExportOption(EXPORT_EVENTS, "Export event rule hits as csv file");
+  AddExportExtension(EXPORT_EVENTS, "csv", "csv");
+
+  AddExportOption(EXPORT_SIGNAL_QUALITY, "Export signal quality report as csv file");
+  AddExportExtension(EXPORT_SIGNAL_QUALITY, "csv", "csv");
 
   ClearChannels();
   AddChannel(m_inputChannel, "IEbus", false);
@@ -68,10 +120,61 @@ auto IEBusAnalyzerSettings::getStartBitWidth() const -> int {
   return m_startBitWidth;
 }
 
+auto IEBusAnalyzerSettings::isMessagesOnly() const -> bool {
+  return m_messagesOnly;
+}
+
+auto IEBusAnalyzerSettings::isAutoTiming() const -> bool {
+  return m_autoTiming;
+}
+
+auto IEBusAnalyzerSettings::getRetainMessages() const -> int {
+  return m_retainMessages;
+}
+
+auto IEBusAnalyzerSettings::getRetainMinutes() const -> int {
+  return m_retainMinutes;
+}
+
+auto IEBusAnalyzerSettings::getDissectorFile() const -> std::string const& {
+  return m_dissectorFile;
+}
+
+auto IEBusAnalyzerSettings::getEventFile() const -> std::string const& {
+  return m_eventFile;
+}
+
 auto IEBusAnalyzerSettings::SetSettingsFromInterfaces() -> bool {
+  // reject a definition file that does not parse here rather than decode without it
+  std::string dissectorFile = m_dissectorFileInterface.GetText();
+  if (not dissectorFile.empty()) {
+    IEBusDissectorRegistry dissectors;
+    std::string error;
+    if (not dissectors.loadFile(dissectorFile, error)) {
+      SetErrorText(error.c_str());
+      return false;
+    }
+  }
+
+  std::string eventFile = m_eventFileInterface.GetText();
+  if (not eventFile.empty()) {
+    IEBusEventMatcher matcher;
+    std::string error;
+    if (not matcher.loadFile(eventFile, error)) {
+      SetErrorText(error.c_str());
+      return false;
+    }
+  }
+
   m_dataBitWidth = m_dataBitWidthInterface.GetInteger();
   m_inputChannel = m_inputChannelInterface.GetChannel();
   m_startBitWidth = m_startBitWidthInterface.GetInteger();
+  m_messagesOnly = m_messagesOnlyInterface.GetValue();
+  m_autoTiming = m_autoTimingInterface.GetValue();
+  m_retainMessages = m_retainMessagesInterface.GetInteger();
+  m_retainMinutes = m_retainMinutesInterface.GetInteger();
+  m_dissectorFile = dissectorFile;
+  m_eventFile = eventFile;
 
   ClearChannels();
   AddChannel(m_inputChannel, "IEbus", true);
@@ -86,6 +189,23 @@ auto IEBusAnalyzerSettings::LoadSettings(const char* settings) -> void {
   text_archive >> m_dataBitWidth;
   text_archive >> m_inputChannel;
   text_archive >> m_startBitWidth;
+  // missing from settings saved by older versions
+  if (not(text_archive >> m_messagesOnly)) {
+    m_messagesOnly = false;
+  }
+  if (not(text_archive >> m_autoTiming)) {
+    m_autoTiming = true;
+  }
+  if (not(text_archive >> m_retainMessages)) {
+    m_retainMessages = 0;
+  }
+  if (not(text_archive >> m_retainMinutes)) {
+    m_retainMinutes = 0;
+  }
+  char const* dissectorFile = nullptr;
+  m_dissectorFile = (text_archive >> &dissectorFile) and dissectorFile ? dissectorFile : "";
+  char const* eventFile = nullptr;
+  m_eventFile = (text_archive >> &eventFile) and eventFile ? eventFile : "";
 
   ClearChannels();
   AddChannel(m_inputChannel, "IEbus", true);
@@ -96,16 +216,27 @@ auto IEBusAnalyzerSettings::LoadSettings(const char* settings) -> void {
 auto IEBusAnalyzerSettings::SaveSettings() -> char const* {
   SimpleArchive text_archive;
 
-  text_archive >> m_dataBitWidth;
+  text_archive << m_dataBitWidth;
   text_archive << m_inputChannel;
   text_archive << m_startBitWidth;
+  text_archive << m_messagesOnly;
+  text_archive << m_autoTiming;
+  text_archive << m_retainMessages;
+  text_archive << m_retainMinutes;
+  text_archive << m_dissectorFile.c_str();
+  text_archive << m_eventFile.c_str();
 
   return SetReturnString(text_archive.GetString());
 }
 
 auto IEBusAnalyzerSettings::UpdateInterfacesFromSettings() -> void {
-  m_dataBitWidth = m_dataBitWidthInterface.GetInteger();
-
+  m_dataBitWidthInterface.SetInteger(m_dataBitWidth);
   m_inputChannelInterface.SetChannel(m_inputChannel);
   m_startBitWidthInterface.SetInteger(m_startBitWidth);
+  m_messagesOnlyInterface.SetValue(m_messagesOnly);
+  m_autoTimingInterface.SetValue(m_autoTiming);
+  m_retainMessagesInterface.SetInteger(m_retainMessages);
+  m_retainMinutesInterface.SetInteger(m_retainMinutes);
+  m_dissectorFileInterface.SetText(m_dissectorFile.c_str());
+  m_eventFileInterface.SetText(m_eventFile.c_str());
 }
@@ -0,0 +1,274 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "IEBusCaptureFile.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+static_assert(std::endian::native == std::endian::little, "capture files are read in host byte order");
+
+auto constexpr SALEAE_MAGIC = "<SALEAE>";
+auto constexpr SALEAE_VERSION = 0;
+auto constexpr SALEAE_TYPE_DIGITAL = 0;
+// magic, version, type, initial state, begin time, end time, transition count
+auto constexpr SALEAE_HEADER_SIZE = 8 + 4 + 4 + 4 + 8 + 8 + 8;
+
+auto constexpr EDGE_SIZE = 8;
+
+template <typename T> auto read(char const* in) -> T {
+  T value;
+  std::memcpy(&value, in, sizeof(value));
+  return value;
+}
+
+} // namespace
+
+IEBusCaptureFile::IEBusCaptureFile(std::string const& path) {
+  if (map(path) and not parse()) {
+    unmap();
+  }
+}
+
+IEBusCaptureFile::~IEBusCaptureFile() {
+  unmap();
+}
+
+auto IEBusCaptureFile::isOpen() const -> bool {
+  return m_data != nullptr;
+}
+
+auto IEBusCaptureFile::getError() const -> std::string const& {
+  return m_error;
+}
+
+auto IEBusCaptureFile::isSaleaeBinary() const -> bool {
+  return m_saleaeBinary;
+}
+
+auto IEBusCaptureFile::isInitialHigh() const -> bool {
+  return m_initialHigh;
+}
+
+auto IEBusCaptureFile::getBeginTime() const -> double {
+  return m_beginTime;
+}
+
+auto IEBusCaptureFile::getOriginTime() const -> double {
+  return std::min(m_beginTime, 0.0);
+}
+
+auto IEBusCaptureFile::getTriggerSample(double sampleRateHz) const -> std::uint64_t {
+  return static_cast<std::uint64_t>(std::llround(-getOriginTime() * sampleRateHz));
+}
+
+auto IEBusCaptureFile::getEdgeCount() const -> std::uint64_t {
+  return m_edgeCount;
+}
+
+auto IEBusCaptureFile::getEdges() const -> char const* {
+  return m_edges;
+}
+
+#ifdef _WIN32
+
+auto IEBusCaptureFile::map(std::string const& path) -> bool {
+  m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (m_file == INVALID_HANDLE_VALUE) {
+    m_file = nullptr;
+    m_error = "cannot open file";
+    return false;
+  }
+
+  LARGE_INTEGER size;
+  if (not GetFileSizeEx(m_file, &size) or size.QuadPart == 0) {
+    m_error = "file is empty";
+    unmap();
+    return false;
+  }
+
+  m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (m_mapping == nullptr) {
+    m_error = "cannot map file";
+    unmap();
+    return false;
+  }
+
+  m_data = static_cast<char const*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+  if (m_data == nullptr) {
+    m_error = "cannot map file";
+    unmap();
+    return false;
+  }
+
+  m_size = static_cast<std::size_t>(size.QuadPart);
+  return true;
+}
+
+auto IEBusCaptureFile::unmap() -> void {
+  if (m_data != nullptr) {
+    UnmapViewOfFile(m_data);
+  }
+  if (m_mapping != nullptr) {
+    CloseHandle(m_mapping);
+  }
+  if (m_file != nullptr) {
+    CloseHandle(m_file);
+  }
+
+  m_data = nullptr;
+  m_mapping = nullptr;
+  m_file = nullptr;
+  m_size = 0;
+}
+
+#else
+
+auto IEBusCaptureFile::map(std::string const& path) -> bool {
+  auto const fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    m_error = "cannot open file";
+    return false;
+  }
+
+  struct stat status {};
+  if (::fstat(fd, &status) != 0 or status.st_size == 0) {
+    m_error = "file is empty";
+    ::close(fd);
+    return false;
+  }
+
+  auto const size = static_cast<std::size_t>(status.st_size);
+  auto const data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping keeps its own reference to the file
+  ::close(fd);
+
+  if (data == MAP_FAILED) {
+    m_error = "cannot map file";
+    return false;
+  }
+  ::madvise(data, size, MADV_SEQUENTIAL);
+
+  m_data = static_cast<char const*>(data);
+  m_size = size;
+  return true;
+}
+
+auto IEBusCaptureFile::unmap() -> void {
+  if (m_data != nullptr) {
+    ::munmap(const_cast<char*>(m_data), m_size);
+  }
+
+  m_data = nullptr;
+  m_size = 0;
+}
+
+#endif
+
+auto IEBusCaptureFile::parse() -> bool {
+  if (m_size >= SALEAE_HEADER_SIZE and std::memcmp(m_data, SALEAE_MAGIC, 8) == 0) {
+    auto const version = read<std::int32_t>(m_data + 8);
+    auto const type = read<std::int32_t>(m_data + 12);
+    if (version != SALEAE_VERSION or type != SALEAE_TYPE_DIGITAL) {
+      m_error = "unsupported Saleae export, expected a digital channel in binary format version 0";
+      return false;
+    }
+
+    m_saleaeBinary = true;
+    m_initialHigh = read<std::uint32_t>(m_data + 16) != 0;
+    m_beginTime = read<double>(m_data + 20);
+    m_edgeCount = read<std::uint64_t>(m_data + 36);
+    m_edges = m_data + SALEAE_HEADER_SIZE;
+
+    if (m_edgeCount > (m_size - SALEAE_HEADER_SIZE) / EDGE_SIZE) {
+      m_error = "truncated Saleae export";
+      return false;
+    }
+    return true;
+  }
+
+  if (m_size % EDGE_SIZE != 0) {
+    m_error = "raw edge file size is not a multiple of 8 bytes";
+    return false;
+  }
+
+  m_edgeCount = m_size / EDGE_SIZE;
+  m_edges = m_data;
+  return true;
+}
+
+IEBusCaptureEdgeSource::IEBusCaptureEdgeSource(IEBusCaptureFile const& file, double sampleRateHz, bool initialHigh)
+    : m_file(file), m_sampleRateHz(sampleRateHz), m_high(initialHigh) {
+}
+
+auto IEBusCaptureEdgeSource::getSampleNumber() -> std::uint64_t {
+  return m_sampleNumber;
+}
+
+auto IEBusCaptureEdgeSource::isHigh() -> bool {
+  return m_high;
+}
+
+auto IEBusCaptureEdgeSource::isEdgeAvailable() -> bool {
+  return m_next < m_file.getEdgeCount();
+}
+
+auto IEBusCaptureEdgeSource::advanceToNextEdge() -> bool {
+  if (m_next == m_file.getEdgeCount()) {
+    return false;
+  }
+
+  m_sampleNumber = getSampleAt(m_next);
+  m_high = not m_high;
+  m_next++;
+  return true;
+}
+
+auto IEBusCaptureEdgeSource::readSamples(std::span<std::uint64_t> samples) -> std::size_t {
+  auto const count = static_cast<std::size_t>(std::min<std::uint64_t>(samples.size(), m_file.getEdgeCount() - m_next));
+  for (std::size_t i = 0; i < count; i++) {
+    samples[i] = getSampleAt(m_next + i);
+  }
+
+  if (count > 0) {
+    m_sampleNumber = samples[count - 1];
+    m_high = m_high != (count % 2 == 1);
+    m_next += count;
+  }
+  return count;
+}
+
+auto IEBusCaptureEdgeSource::getSampleAt(std::uint64_t index) const -> std::uint64_t {
+  auto const edge = m_file.getEdges() + index * EDGE_SIZE;
+  if (m_file.isSaleaeBinary()) {
+    auto const seconds = read<double>(edge) - m_file.getOriginTime();
+    return static_cast<std::uint64_t>(std::llround(seconds * m_sampleRateHz));
+  }
+  return read<std::uint64_t>(edge);
+}
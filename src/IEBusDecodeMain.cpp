@@ -0,0 +1,357 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "IEBusCaptureFile.hpp"
+#include "IEBusDecoder.hpp"
+#include "IEBusDeltaWriter.hpp"
+#include "IEBusDissector.hpp"
+#include "IEBusEventMatcher.hpp"
+#include "IEBusEventWriter.hpp"
+#include "IEBusMessageWriter.hpp"
+#include "IEBusSignalQuality.hpp"
+#include "IEBusTimingDetector.hpp"
+#include "IEBusTrafficStats.hpp"
+
+namespace {
+
+auto constexpr USAGE = R"(usage: iebus-decode [options] <capture>...
+
+Decodes Saleae Logic 2 digital binary exports or raw u64 edge files.
+
+options:
+  --format csv|binary|delta|stats|quality
+                          message export format, delta collapses repeated messages, stats writes
+                          one line of totals per (master, slave, control) stream, quality writes
+                          pulse width statistics per node (default: csv)
+  --output-dir <dir>      where to write the exports (default: next to each capture)
+  --sample-rate <hz>      sample rate used for edge timestamps (default: 10000000)
+  --bit-width <us>        data bit width in uS (default: 39)
+  --start-bit-width <us>  start bit width in uS (default: 171)
+  --fixed-timing          use the widths above instead of detecting them from each capture
+  --dissectors <file>     application-layer command definitions, see IEBusDissector.hpp
+  --events <file>         event rules, hits are also written to <name>.events.csv, see IEBusEventMatcher.hpp
+  --initial-high          raw edge files start with the line high
+  --jobs <n>              number of captures decoded at once (default: hardware threads)
+)";
+
+// edges converted from the mapped capture per decoder call
+auto constexpr EDGE_CHUNK = 4096;
+
+enum class Format { Csv, Binary, Delta, Stats, Quality };
+
+struct Options {
+  Format format = Format::Csv;
+  std::filesystem::path outputDir;
+  double sampleRateHz = 10000000.0;
+  double dataBitWidthUs = 39.0;
+  double startBitWidthUs = 171.0;
+  bool initialHigh = false;
+  bool autoTiming = true;
+  std::string dissectorFile;
+  std::string eventFile;
+  unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::filesystem::path> captures;
+};
+
+auto parseOptions(int argc, char** argv, Options& options) -> bool {
+  for (int i = 1; i < argc; i++) {
+    auto const arg = std::string_view(argv[i]);
+    auto const hasValue = i + 1 < argc;
+
+    if (arg == "--format" and hasValue) {
+      auto const format = std::string_view(argv[++i]);
+      if (format == "csv") {
+        options.format = Format::Csv;
+      } else if (format == "binary") {
+        options.format = Format::Binary;
+      } else if (format == "delta") {
+        options.format = Format::Delta;
+      } else if (format == "stats") {
+        options.format = Format::Stats;
+      } else if (format == "quality") {
+        options.format = Format::Quality;
+      } else {
+        return false;
+      }
+    } else if (arg == "--output-dir" and hasValue) {
+      options.outputDir = argv[++i];
+    } else if (arg == "--sample-rate" and hasValue) {
+      options.sampleRateHz = std::stod(argv[++i]);
+    } else if (arg == "--bit-width" and hasValue) {
+      options.dataBitWidthUs = std::stod(argv[++i]);
+    } else if (arg == "--start-bit-width" and hasValue) {
+      options.startBitWidthUs = std::stod(argv[++i]);
+    } else if (arg == "--initial-high") {
+      options.initialHigh = true;
+    } else if (arg == "--fixed-timing") {
+      options.autoTiming = false;
+    } else if (arg == "--dissectors" and hasValue) {
+      options.dissectorFile = argv[++i];
+    } else if (arg == "--events" and hasValue) {
+      options.eventFile = argv[++i];
+    } else if (arg == "--jobs" and hasValue) {
+      options.jobs = std::max(1, std::stoi(argv[++i]));
+    } else if (arg.starts_with("--")) {
+      return false;
+    } else {
+      options.captures.emplace_back(arg);
+    }
+  }
+
+  return not options.captures.empty() and options.sampleRateHz > 0.0;
+}
+
+auto outputPathFor(Options const& options, std::filesystem::path const& capture) -> std::filesystem::path {
+  auto output = options.outputDir.empty() ? capture : options.outputDir / capture.filename();
+  switch (options.format) {
+  case Format::Csv:
+    output.replace_extension(".csv");
+    break;
+  case Format::Binary:
+    output.replace_extension(".iebus");
+    break;
+  case Format::Delta:
+    output.replace_extension(".delta.csv");
+    break;
+  case Format::Stats:
+    output.replace_extension(".stats.csv");
+    break;
+  case Format::Quality:
+    output.replace_extension(".quality.csv");
+    break;
+  }
+  return output;
+}
+
+auto eventsPathFor(Options const& options, std::filesystem::path const& capture) -> std::filesystem::path {
+  auto output = options.outputDir.empty() ? capture : options.outputDir / capture.filename();
+  return output.replace_extension(".events.csv");
+}
+
+// hands every message to the export and, with rules, to the event export; pulses only go to the export
+class MessageTee : public IEBusDecoderListener {
+public:
+  MessageTee(IEBusDecoderListener& output, IEBusDecoderListener* events) : m_output(output), m_events(events) {
+  }
+
+public:
+  auto onPulse(IEBusPulse const& pulse) -> void override {
+    m_output.onPulse(pulse);
+  }
+
+  auto onMessage(IEBusMessage const& message) -> void override {
+    m_output.onMessage(message);
+    if (m_events) {
+      m_events->onMessage(message);
+    }
+  }
+
+private:
+  IEBusDecoderListener& m_output;
+  IEBusDecoderListener* m_events;
+};
+
+auto detectTiming(Options const& options, IEBusCaptureFile const& file, bool initialHigh, IEBusTiming& timing) -> std::string {
+  IEBusCaptureEdgeSource source(file, options.sampleRateHz, initialHigh);
+  IEBusTimingDetector detector;
+  detector.scan(source);
+
+  auto const detected = detector.detect();
+  if (not detected) {
+    return "timing not detected, using configured widths";
+  }
+  timing = detected->timing;
+
+  auto const samplesPerUs = options.sampleRateHz / 1000000.0;
+  auto report = std::array<char, 128>();
+  std::snprintf(report.data(), report.size(), "start bit %.1f uS, bit %.1f uS (one %.1f uS, zero %.1f uS)", detected->startWidth / samplesPerUs,
+                static_cast<double>(timing.dataBitWidth) / samplesPerUs, detected->oneWidth / samplesPerUs, detected->zeroWidth / samplesPerUs);
+  return report.data();
+}
+
+auto decodeEdges(Options const& options, IEBusCaptureFile const& file, bool initialHigh, IEBusTiming const& timing, IEBusDecoderListener& listener,
+                 IEBusDecoderListener* events) -> void {
+  IEBusCaptureEdgeSource source(file, options.sampleRateHz, initialHigh);
+  MessageTee tee(listener, events);
+  IEBusDecoder decoder(timing, tee);
+  decoder.setLineState(0, initialHigh);
+
+  // the decoder picks up each chunk where the previous one stopped
+  auto samples = std::vector<std::uint64_t>(EDGE_CHUNK);
+  for (auto count = source.readSamples(samples); count > 0; count = source.readSamples(samples)) {
+    decoder.pushEdges(std::span(samples).first(count));
+  }
+}
+
+auto decodeCapture(Options const& options, IEBusDissectorRegistry const& dissectors, IEBusEventMatcher const* rules, std::filesystem::path const& capture,
+                   std::string& report, std::string& error) -> bool {
+  IEBusCaptureFile file(capture.string());
+  if (not file.isOpen()) {
+    error = file.getError();
+    return false;
+  }
+
+  auto const output = outputPathFor(options, capture);
+  std::ofstream stream(output, std::ios::out | std::ios::binary);
+  if (not stream) {
+    error = "cannot create " + output.string();
+    return false;
+  }
+
+  auto const triggerSample = file.getTriggerSample(options.sampleRateHz);
+
+  // each capture counts rate thresholds from zero
+  std::optional<IEBusEventMatcher> matcher;
+  std::ofstream eventStream;
+  std::optional<IEBusEventWriter> events;
+  if (rules) {
+    matcher = *rules;
+    auto const eventsPath = eventsPathFor(options, capture);
+    eventStream.open(eventsPath, std::ios::out | std::ios::binary);
+    if (not eventStream) {
+      error = "cannot create " + eventsPath.string();
+      return false;
+    }
+    events.emplace(eventStream, *matcher, options.sampleRateHz, triggerSample);
+  }
+  auto const eventListener = events ? &*events : nullptr;
+
+  auto const initialHigh = file.isSaleaeBinary() ? file.isInitialHigh() : options.initialHigh;
+  auto timing = IEBusTiming::fromMicroseconds(options.startBitWidthUs, options.dataBitWidthUs, options.sampleRateHz);
+  if (options.autoTiming) {
+    report = detectTiming(options, file, initialHigh, timing);
+  }
+
+  if (options.format == Format::Delta) {
+    IEBusDeltaWriter writer(stream, options.sampleRateHz, triggerSample);
+    decodeEdges(options, file, initialHigh, timing, writer, eventListener);
+    writer.finish();
+  } else if (options.format == Format::Stats) {
+    IEBusTrafficStats stats;
+    decodeEdges(options, file, initialHigh, timing, stats, eventListener);
+    stats.write(stream, options.sampleRateHz, triggerSample);
+  } else if (options.format == Format::Quality) {
+    IEBusSignalQuality quality(timing);
+    decodeEdges(options, file, initialHigh, timing, quality, eventListener);
+    quality.write(stream, options.sampleRateHz);
+  } else {
+    IEBusMessageWriter writer(stream, options.format == Format::Binary ? IEBusMessageWriter::Format::Binary : IEBusMessageWriter::Format::Csv, options.sampleRateHz,
+                              triggerSample, &dissectors);
+    decodeEdges(options, file, initialHigh, timing, writer, eventListener);
+  }
+
+  stream.close();
+  if (not stream) {
+    error = "cannot write " + output.string();
+    return false;
+  }
+  if (rules) {
+    eventStream.close();
+    if (not eventStream) {
+      error = "cannot write " + eventsPathFor(options, capture).string();
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+auto main(int argc, char** argv) -> int {
+  Options options;
+  try {
+    if (not parseOptions(argc, argv, options)) {
+      std::cerr << USAGE;
+      return 2;
+    }
+  } catch (std::exception const&) {
+    std::cerr << USAGE;
+    return 2;
+  }
+
+  // shared read-only by all workers
+  IEBusDissectorRegistry dissectors;
+  if (not options.dissectorFile.empty()) {
+    std::string error;
+    if (not dissectors.loadFile(options.dissectorFile, error)) {
+      std::cerr << options.dissectorFile << ": " << error << std::endl;
+      return 2;
+    }
+  }
+
+  IEBusEventMatcher rules;
+  if (not options.eventFile.empty()) {
+    std::string error;
+    if (not rules.loadFile(options.eventFile, error)) {
+      std::cerr << options.eventFile << ": " << error << std::endl;
+      return 2;
+    }
+    rules.compile(options.sampleRateHz);
+  }
+  auto const eventRules = options.eventFile.empty() ? nullptr : &rules;
+
+  std::atomic<std::size_t> nextCapture = 0;
+  std::atomic<bool> failed = false;
+  std::mutex outputMutex;
+
+  auto const worker = [&] {
+    for (auto index = nextCapture++; index < options.captures.size(); index = nextCapture++) {
+      auto const& capture = options.captures[index];
+
+      std::string report;
+      std::string error;
+      auto const ok = decodeCapture(options, dissectors, eventRules, capture, report, error);
+
+      std::scoped_lock lock(outputMutex);
+      if (ok) {
+        std::cout << capture.string() << " -> " << outputPathFor(options, capture).string();
+        if (eventRules) {
+          std::cout << ", " << eventsPathFor(options, capture).string();
+        }
+        if (not report.empty()) {
+          std::cout << ": " << report;
+        }
+        std::cout << std::endl;
+      } else {
+        std::cerr << capture.string() << ": " << error << std::endl;
+        failed = true;
+      }
+    }
+  };
+
+  auto const threadCount = std::min<std::size_t>(options.jobs, options.captures.size());
+  std::vector<std::jthread> threads;
+  threads.reserve(threadCount);
+  for (std::size_t i = 0; i < threadCount; i++) {
+    threads.emplace_back(worker);
+  }
+  threads.clear();
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,333 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "IEBusDecoder.hpp"
+
+#include <array>
+#include <cmath>
+
+auto IEBusTiming::fromMicroseconds(double startBitWidthUs, double dataBitWidthUs, double sampleRateHz) -> IEBusTiming {
+  auto const samplesPerUs = sampleRateHz / 1000000.0;
+
+  IEBusTiming timing;
+  timing.startBitWidth = static_cast<std::uint64_t>(std::llround(startBitWidthUs * samplesPerUs));
+  timing.dataBitWidth = static_cast<std::uint64_t>(std::llround(dataBitWidthUs * samplesPerUs));
+  return timing;
+}
+
+auto IEBusEdgeSource::isEdgeAvailable() -> bool {
+  return true;
+}
+
+auto IEBusDecoderListener::onMarker(std::uint64_t sample, Marker marker) -> void {
+}
+
+auto IEBusDecoderListener::onField(IEBusField const& field) -> void {
+}
+
+auto IEBusDecoderListener::onMessage(IEBusMessage const& message) -> void {
+}
+
+auto IEBusDecoderListener::onPulse(IEBusPulse const& pulse) -> void {
+}
+
+namespace {
+
+// bits of one field, in the order they appear on the bus
+struct FieldLayout {
+  std::uint8_t type;
+  std::uint8_t dataBits;
+  bool parity;
+  bool ack;
+  // bits that are neither a one nor a zero abandon the message
+  bool strict;
+};
+
+// indexed by IEBusDecoder::State, Hunt has no field
+auto constexpr FIELD_LAYOUTS = std::array{
+    FieldLayout{0, 0, false, false, false},
+    FieldLayout{IEBusFieldType::HEADER, 1, false, false, false},
+    FieldLayout{IEBusFieldType::MASTER, 12, true, false, true},
+    FieldLayout{IEBusFieldType::SLAVE, 12, true, true, true},
+    FieldLayout{IEBusFieldType::CONTROL, 4, true, true, false},
+    FieldLayout{IEBusFieldType::LENGTH, 8, true, true, false},
+    FieldLayout{IEBusFieldType::DATA, 8, true, true, false},
+};
+
+} // namespace
+
+IEBusDecoder::IEBusDecoder(IEBusTiming const& timing, IEBusDecoderListener& listener)
+    : m_listener(listener), m_startBitWidth(timing.startBitWidth), m_oneBitLen(timing.dataBitWidth / 2),
+      m_zeroBitLen(static_cast<std::uint64_t>(static_cast<double>(timing.dataBitWidth) * 0.875)), m_toleranceStart(timing.startBitWidth / 10),
+      m_toleranceBit(timing.dataBitWidth / 10) {
+}
+
+auto IEBusDecoder::setLineState(std::uint64_t sample, bool high) -> void {
+  m_state = State::Hunt;
+  m_high = high;
+  m_risen = high;
+
+  // a line that is already high may be inside a start bit
+  m_startSampleNumberStart = sample;
+  m_startBitNumberStart = sample;
+}
+
+auto IEBusDecoder::pushEdge(std::uint64_t sample, bool high) -> void {
+  if (high == m_high) {
+    return;
+  }
+  m_high = high;
+
+  if (high) {
+    onRisingEdge(sample);
+  } else {
+    onFallingEdge(sample);
+  }
+}
+
+auto IEBusDecoder::pushEdges(std::span<std::uint64_t const> samples) -> void {
+  for (auto const sample : samples) {
+    pushEdge(sample, not m_high);
+  }
+}
+
+auto IEBusDecoder::run(IEBusEdgeSource& source) -> void {
+  setLineState(source.getSampleNumber(), source.isHigh());
+
+  while (source.advanceToNextEdge()) {
+    pushEdge(source.getSampleNumber(), source.isHigh());
+  }
+}
+
+auto IEBusDecoder::onRisingEdge(std::uint64_t sample) -> void {
+  m_risen = true;
+  m_startBitNumberStart = sample;
+
+  // while searching every high pulse may be the start bit
+  if (m_state == State::Hunt or m_bit == 0) {
+    m_startSampleNumberStart = sample;
+  }
+  if (m_state != State::Hunt) {
+    m_listener.onMarker(sample, IEBusDecoderListener::Marker::Dot);
+  }
+}
+
+auto IEBusDecoder::onFallingEdge(std::uint64_t sample) -> void {
+  if (not m_risen) {
+    return;
+  }
+
+  m_startSampleNumberFinish = sample;
+  m_measureWidth = m_startSampleNumberFinish - m_startBitNumberStart;
+
+  if (m_state != State::Hunt) {
+    decodeBit();
+  } else if (m_measureWidth > m_startBitWidth - m_toleranceStart and m_measureWidth < m_startBitWidth + m_toleranceStart) {
+    beginMessage();
+  }
+}
+
+auto IEBusDecoder::beginMessage() -> void {
+  reportPulse(IEBusPulse::Kind::Start, false, isNearThreshold(m_startBitWidth, m_toleranceStart));
+
+  m_listener.onMarker(m_startSampleNumberStart, IEBusDecoderListener::Marker::UpArrow);
+  m_listener.onMarker(m_startSampleNumberFinish, IEBusDecoderListener::Marker::Start);
+
+  m_message.data.clear();
+  m_message.startSample = m_startSampleNumberStart;
+  m_message.endSample = m_startSampleNumberFinish;
+  m_message.header = 0;
+  m_message.master = 0;
+  m_message.slave = 0;
+  m_message.control = 0;
+  m_message.length = 0;
+  m_message.flags = 0;
+  m_message.hasControl = false;
+
+  m_data = 0;
+  update(m_startSampleNumberStart, IEBusFieldType::START, 0);
+
+  m_state = State::Header;
+  m_bit = 0;
+  m_flags = 0;
+  m_parity = 0;
+}
+
+auto IEBusDecoder::decodeBit() -> void {
+  auto const& layout = FIELD_LAYOUTS[static_cast<std::size_t>(m_state)];
+  auto const one = isOneBit();
+
+  if (layout.strict and not one and not isZeroBit()) {
+    // not an IEBus bit, look for the next start bit
+    m_state = State::Hunt;
+    return;
+  }
+
+  // the slave acknowledges what the master writes and sends what it reads
+  auto const ack = layout.ack and m_bit == layout.dataBits + (layout.parity ? 1 : 0);
+  auto const read = (m_state == State::Length or m_state == State::Data) and (m_message.control & 0x8) == 0;
+  auto const nearThreshold = one ? isNearThreshold(m_oneBitLen, m_toleranceBit) : not isZeroBit() or isNearThreshold(m_zeroBitLen, m_toleranceBit);
+  reportPulse(ack ? IEBusPulse::Kind::Ack : (one ? IEBusPulse::Kind::One : IEBusPulse::Kind::Zero), ack != read, nearThreshold);
+
+  if (m_bit < layout.dataBits) {
+    if (one) {
+      m_data |= std::uint64_t{1} << (layout.dataBits - 1 - m_bit);
+      m_parity ^= 1;
+    }
+    markBit(one);
+  } else if (layout.parity and m_bit == layout.dataBits) {
+    checkParity();
+  } else {
+    checkAck();
+  }
+
+  if (++m_bit == layout.dataBits + (layout.parity ? 1 : 0) + (layout.ack ? 1 : 0)) {
+    completeField(layout.type);
+  }
+}
+
+auto IEBusDecoder::completeField(std::uint8_t type) -> void {
+  switch (m_state) {
+  case State::Header:
+    m_message.header = static_cast<std::uint8_t>(m_data);
+    break;
+  case State::Master:
+    m_message.master = static_cast<std::uint16_t>(m_data);
+    break;
+  case State::Slave:
+    m_message.slave = static_cast<std::uint16_t>(m_data);
+    break;
+  case State::Control:
+    m_message.control = static_cast<std::uint8_t>(m_data);
+    m_message.hasControl = true;
+    break;
+  case State::Length:
+    m_message.length = static_cast<std::uint8_t>(m_data);
+    break;
+  case State::Data:
+    m_message.data.push_back(static_cast<std::uint8_t>(m_data));
+    break;
+  case State::Hunt:
+    break;
+  }
+
+  auto const flags = m_flags;
+  update(m_startSampleNumberStart, type, flags);
+
+  m_bit = 0;
+  m_flags = 0;
+  m_parity = 0;
+
+  switch (m_state) {
+  case State::Header:
+    m_state = State::Master;
+    break;
+  case State::Master:
+    m_state = State::Slave;
+    break;
+  case State::Slave:
+    // the slave did not acknowledge its address, nothing else follows
+    if (flags & IEBusFlag::NAK) {
+      completeMessage();
+    } else {
+      m_state = State::Control;
+    }
+    break;
+  case State::Control:
+    m_state = State::Length;
+    break;
+  case State::Length:
+    m_remaining = m_message.length;
+    if (m_remaining == 0) {
+      completeMessage();
+    } else {
+      m_state = State::Data;
+    }
+    break;
+  case State::Data:
+    if (--m_remaining == 0) {
+      completeMessage();
+    }
+    break;
+  case State::Hunt:
+    break;
+  }
+}
+
+auto IEBusDecoder::completeMessage() -> void {
+  m_listener.onMessage(m_message);
+  m_state = State::Hunt;
+}
+
+auto IEBusDecoder::checkParity() -> void {
+  // the parity bit makes the number of ones in the field even
+  if ((isOneBit() ? 1 : 0) == m_parity) {
+    markBit(isOneBit());
+    return;
+  }
+
+  m_flags |= IEBusFlag::PARITY_ERROR;
+  m_listener.onMarker(m_startSampleNumberFinish, IEBusDecoderListener::Marker::ErrorX);
+}
+
+auto IEBusDecoder::checkAck() -> void {
+  // nobody acknowledges a broadcast, the line just stays at one
+  if (isOneBit() and not m_message.isBroadcast()) {
+    m_flags |= IEBusFlag::NAK;
+  }
+  markBit(isOneBit());
+}
+
+auto IEBusDecoder::markBit(bool one) -> void {
+  m_listener.onMarker(m_startSampleNumberFinish, one ? IEBusDecoderListener::Marker::One : IEBusDecoderListener::Marker::Zero);
+}
+
+auto IEBusDecoder::update(std::uint64_t startingSample, std::uint8_t type, std::uint8_t flags) -> void {
+  IEBusField field;
+  field.startSample = startingSample;
+  field.endSample = m_startSampleNumberFinish;
+  field.value = m_data;
+  field.type = type;
+  field.flags = flags;
+
+  m_listener.onField(field);
+
+  m_message.endSample = field.endSample;
+  m_message.flags |= flags;
+  m_data = 0;
+}
+
+auto IEBusDecoder::isOneBit() const -> bool {
+  return m_measureWidth > m_oneBitLen - m_toleranceBit and m_measureWidth < m_oneBitLen + m_toleranceBit;
+}
+
+auto IEBusDecoder::isZeroBit() const -> bool {
+  return m_measureWidth > m_zeroBitLen - m_toleranceBit and m_measureWidth < m_zeroBitLen + m_toleranceBit;
+}
+
+auto IEBusDecoder::isNearThreshold(std::uint64_t nominal, std::uint64_t tolerance) const -> bool {
+  auto const deviation = m_measureWidth > nominal ? m_measureWidth - nominal : nominal - m_measureWidth;
+  return deviation * 4 > tolerance * 3;
+}
+
+auto IEBusDecoder::reportPulse(IEBusPulse::Kind kind, bool fromSlave, bool nearThreshold) -> void {
+  IEBusPulse pulse;
+  pulse.sample = m_startBitNumberStart;
+  pulse.width = m_measureWidth;
+  pulse.kind = kind;
+  pulse.fromSlave = fromSlave;
+  pulse.driven = kind != IEBusPulse::Kind::Ack or not isOneBit();
+  pulse.nearThreshold = nearThreshold;
+  m_listener.onPulse(pulse);
+}
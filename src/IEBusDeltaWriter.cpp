@@ -0,0 +1,133 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "IEBusDeltaWriter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <limits>
+
+namespace {
+
+auto constexpr LINE_LENGTH = 160;
+
+} // namespace
+
+IEBusDeltaWriter::IEBusDeltaWriter(std::ostream& stream, double sampleRateHz, std::uint64_t triggerSample)
+    : m_stream(stream), m_time{sampleRateHz, triggerSample} {
+  m_stream << "Time [s],Event,Master,Slave,Control,Length,Data,NAK,Parity Error,Repeats,Period [s]\n";
+}
+
+auto IEBusDeltaWriter::write(IEBusMessage const& message, std::uint32_t id) -> void {
+  auto const [it, inserted] = m_streams.try_emplace(IEBusMessageDictionary::streamKey(message));
+  auto& stream = it->second;
+  m_messages++;
+
+  if (not inserted and stream.id == id and stream.flags == message.flags) {
+    stream.repeats++;
+    stream.lastSample = message.startSample;
+    stream.lastMessage = m_messages;
+    return;
+  }
+
+  if (inserted) {
+    writeMessage("new", message);
+  } else {
+    writeRepeats(stream);
+    writeMessage("change", message);
+  }
+
+  stream.id = id;
+  stream.flags = message.flags;
+  stream.master = message.master;
+  stream.slave = message.slave;
+  stream.control = message.control;
+  stream.hasControl = message.hasControl;
+  stream.runStartSample = message.startSample;
+  stream.lastSample = message.startSample;
+  stream.lastMessage = m_messages;
+  stream.repeats = 0;
+
+  flushLines();
+}
+
+auto IEBusDeltaWriter::finish() -> void {
+  for (auto const& [key, stream] : m_streams) {
+    writeRepeats(stream);
+  }
+
+  m_streams.clear();
+  flushLines();
+}
+
+auto IEBusDeltaWriter::onMessage(IEBusMessage const& message) -> void {
+  write(message, m_dictionary.intern(message));
+}
+
+auto IEBusDeltaWriter::writeMessage(char const* event, IEBusMessage const& message) -> void {
+  auto line = std::array<char, LINE_LENGTH>();
+  auto const lineLength = std::snprintf(line.data(), line.size(), "%.9f,%s,", m_time.toSeconds(message.startSample), event);
+
+  m_line.write(line.data(), lineLength);
+  IEBusText::writeMessageColumns(m_line, message);
+  m_line << ",,\n";
+  queueLine(message.startSample);
+}
+
+auto IEBusDeltaWriter::writeRepeats(Stream const& stream) -> void {
+  if (stream.repeats == 0) {
+    return;
+  }
+
+  auto const period = m_time.toSeconds(stream.lastSample) - m_time.toSeconds(stream.runStartSample);
+
+  auto line = std::array<char, LINE_LENGTH>();
+  auto const lineLength = std::snprintf(line.data(), line.size(), "%.9f,repeat,0x%03X,0x%03X,%s,,,,,%llu,%.9f\n", m_time.toSeconds(stream.lastSample), stream.master,
+                                        stream.slave, IEBusText::formatControl(stream.control, stream.hasControl), static_cast<unsigned long long>(stream.repeats),
+                                        period / static_cast<double>(stream.repeats));
+  m_line.write(line.data(), lineLength);
+  queueLine(stream.lastSample);
+}
+
+auto IEBusDeltaWriter::queueLine(std::uint64_t sample) -> void {
+  m_lines.emplace(sample, m_line.str());
+  m_line.str({});
+}
+
+// writes the lines older than every run still open, whose repeat line is stamped no earlier than its last message
+auto IEBusDeltaWriter::flushLines() -> void {
+  auto oldest = std::numeric_limits<std::uint64_t>::max();
+  for (auto& [key, stream] : m_streams) {
+    if (stream.repeats == 0) {
+      continue;
+    }
+
+    // a run that went silent would hold back every later line, close it; further repeats start a new run
+    if (m_messages - stream.lastMessage >= MAX_SILENT_MESSAGES) {
+      writeRepeats(stream);
+      stream.runStartSample = stream.lastSample;
+      stream.repeats = 0;
+      continue;
+    }
+
+    oldest = std::min(oldest, stream.lastSample);
+  }
+
+  auto const end = m_streams.empty() ? m_lines.end() : m_lines.lower_bound(oldest);
+  for (auto it = m_lines.begin(); it != end; ++it) {
+    m_stream << it->second;
+  }
+  m_lines.erase(m_lines.begin(), end);
+}
@@ -0,0 +1,252 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "IEBusDissector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+
+#include "IEBusText.hpp"
+
+namespace {
+
+// IEBus control codes, reserved ones have no name
+auto constexpr CONTROL_NAMES = std::array<char const*, 16>{
+    "read-slave-status", nullptr, nullptr, "read-data-and-lock", "read-lock-address-low", "read-lock-address-high", "read-slave-status-and-unlock", "read-data",
+    nullptr, nullptr, "write-command-and-lock", "write-data-and-lock", nullptr, nullptr, "write-command", "write-data",
+};
+
+// key layout: slave (12 bits), ANY_SLAVE flag, control (4 bits), prefix length (3 bits), prefix bytes
+auto constexpr KEY_ANY_SLAVE = std::uint64_t{1} << 12;
+auto constexpr KEY_CONTROL_SHIFT = 13;
+auto constexpr KEY_LENGTH_SHIFT = 17;
+auto constexpr KEY_PREFIX_SHIFT = 20;
+
+// "<name>:<offset>", "<name>:<first>-<last>" or "<name>:<first>-"
+auto parseField(std::string_view text, IEBusCommandField& field) -> bool {
+  auto const colon = text.find(':');
+  if (colon == std::string_view::npos or colon == 0) {
+    return false;
+  }
+  field.name = text.substr(0, colon);
+
+  auto range = text.substr(colon + 1);
+  auto const dash = range.find('-');
+  unsigned first = 0;
+  if (not IEBusText::parseDecimal(range.substr(0, dash), 255, first)) {
+    return false;
+  }
+  field.offset = static_cast<std::uint8_t>(first);
+  field.length = 1;
+
+  if (dash != std::string_view::npos) {
+    auto const lastText = range.substr(dash + 1);
+    unsigned last = 0;
+    if (lastText.empty()) {
+      field.length = 0;
+    } else if (IEBusText::parseDecimal(lastText, 255, last) and last >= first and last - first < 8) {
+      field.length = static_cast<std::uint8_t>(last - first + 1);
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto parseCommand(std::string const& line, IEBusCommand& command, std::string& error) -> bool {
+  std::istringstream tokens(line);
+  std::string slave;
+  std::string control;
+  std::string prefix;
+  if (not(tokens >> slave >> control >> prefix >> command.name)) {
+    error = "expected <slave> <control> <prefix> <name>";
+    return false;
+  }
+
+  unsigned value = 0;
+  if (slave == "*") {
+    command.slave = IEBusCommand::ANY_SLAVE;
+  } else if (IEBusText::parseHex(slave, 0xFFF, value)) {
+    command.slave = static_cast<std::uint16_t>(value);
+  } else {
+    error = "bad slave address " + slave;
+    return false;
+  }
+
+  if (not IEBusText::parseHex(control, 0xF, value)) {
+    error = "bad control code " + control;
+    return false;
+  }
+  command.control = static_cast<std::uint8_t>(value);
+
+  if (prefix != "-") {
+    auto bytes = std::string_view(prefix);
+    while (not bytes.empty()) {
+      auto const dot = bytes.find('.');
+      if (not IEBusText::parseHex(bytes.substr(0, dot), 0xFF, value) or command.prefix.size() == IEBusDissectorRegistry::MAX_PREFIX) {
+        error = "bad prefix " + prefix;
+        return false;
+      }
+      command.prefix.push_back(static_cast<std::uint8_t>(value));
+      bytes = dot == std::string_view::npos ? std::string_view() : bytes.substr(dot + 1);
+    }
+  }
+
+  for (std::string field; tokens >> field;) {
+    if (not parseField(field, command.fields.emplace_back())) {
+      error = "bad field " + field;
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+auto IEBusDissectorRegistry::add(IEBusCommand command) -> void {
+  auto const key = makeKey(command.slave, command.control, command.prefix);
+
+  if (command.slave == IEBusCommand::ANY_SLAVE) {
+    m_anySlave = true;
+  } else {
+    m_slaves.set(command.slave);
+  }
+  m_prefixLengths |= static_cast<std::uint8_t>(1u << command.prefix.size());
+
+  auto const [it, inserted] = m_index.try_emplace(key, static_cast<std::uint32_t>(m_commands.size()));
+  if (inserted) {
+    m_commands.push_back(std::move(command));
+  } else {
+    m_commands[it->second] = std::move(command);
+  }
+}
+
+auto IEBusDissectorRegistry::load(std::istream& stream, std::string& error) -> bool {
+  auto lineNumber = 0;
+  for (std::string line; std::getline(stream, line);) {
+    lineNumber++;
+
+    line.erase(std::min(line.find('#'), line.size()));
+    if (line.find_first_not_of(" \t\r") == std::string::npos) {
+      continue;
+    }
+
+    IEBusCommand command;
+    if (not parseCommand(line, command, error)) {
+      error = "line " + std::to_string(lineNumber) + ": " + error;
+      return false;
+    }
+    add(std::move(command));
+  }
+  return true;
+}
+
+auto IEBusDissectorRegistry::loadFile(std::string const& path, std::string& error) -> bool {
+  std::ifstream stream(path);
+  if (not stream) {
+    error = "cannot open " + path;
+    return false;
+  }
+  return load(stream, error);
+}
+
+auto IEBusDissectorRegistry::clear() -> void {
+  m_commands.clear();
+  m_index.clear();
+  m_slaves.reset();
+  m_anySlave = false;
+  m_prefixLengths = 0;
+}
+
+auto IEBusDissectorRegistry::find(IEBusMessage const& message) const -> IEBusCommand const* {
+  auto const ownSlave = m_slaves.test(message.slave & 0xFFF);
+  if (not message.hasControl or (not ownSlave and not m_anySlave)) {
+    return nullptr;
+  }
+
+  auto const payload = std::span<std::uint8_t const>(message.data);
+  for (auto length = static_cast<int>(std::min<std::size_t>(payload.size(), MAX_PREFIX)); length >= 0; length--) {
+    if ((m_prefixLengths & (1u << length)) == 0) {
+      continue;
+    }
+
+    auto const prefix = payload.first(static_cast<std::size_t>(length));
+    if (ownSlave) {
+      if (auto const command = lookup(message.slave, message.control, prefix)) {
+        return command;
+      }
+    }
+    if (m_anySlave) {
+      if (auto const command = lookup(IEBusCommand::ANY_SLAVE, message.control, prefix)) {
+        return command;
+      }
+    }
+  }
+  return nullptr;
+}
+
+auto IEBusDissectorRegistry::getControlName(std::uint8_t control) -> char const* {
+  return CONTROL_NAMES[control & 0xF];
+}
+
+auto IEBusDissectorRegistry::formatFields(IEBusCommand const& command, IEBusMessage const& message, std::string& text) -> void {
+  text.clear();
+
+  auto value = std::array<char, 24>();
+  for (auto const& field : command.fields) {
+    if (field.offset >= message.data.size()) {
+      continue;
+    }
+
+    if (not text.empty()) {
+      text += ' ';
+    }
+    text += field.name;
+    text += '=';
+
+    if (field.length == 0) {
+      auto bytes = std::array<char, IEBusText::HEX_BYTES_LENGTH>();
+      text.append(bytes.data(), IEBusText::formatHexBytes(std::span(message.data).subspan(field.offset), bytes));
+      continue;
+    }
+
+    // multi-byte fields are read most significant byte first
+    auto const last = std::min<std::size_t>(field.offset + field.length, message.data.size());
+    std::uint64_t number = 0;
+    for (auto i = std::size_t{field.offset}; i < last; i++) {
+      number = (number << 8) | message.data[i];
+    }
+    std::snprintf(value.data(), value.size(), "0x%0*llX", static_cast<int>(last - field.offset) * 2, static_cast<unsigned long long>(number));
+    text += value.data();
+  }
+}
+
+auto IEBusDissectorRegistry::makeKey(std::uint16_t slave, std::uint8_t control, std::span<std::uint8_t const> prefix) -> std::uint64_t {
+  auto key = slave == IEBusCommand::ANY_SLAVE ? KEY_ANY_SLAVE : std::uint64_t{slave} & 0xFFF;
+  key |= std::uint64_t{control & 0xFu} << KEY_CONTROL_SHIFT;
+  key |= std::uint64_t{prefix.size()} << KEY_LENGTH_SHIFT;
+  for (std::size_t i = 0; i < prefix.size(); i++) {
+    key |= std::uint64_t{prefix[i]} << (KEY_PREFIX_SHIFT + 8 * i);
+  }
+  return key;
+}
+
+auto IEBusDissectorRegistry::lookup(std::uint16_t slave, std::uint8_t control, std::span<std::uint8_t const> prefix) const -> IEBusCommand const* {
+  auto const it = m_index.find(makeKey(slave, control, prefix));
+  return it == m_index.end() ? nullptr : &m_commands[it->second];
+}
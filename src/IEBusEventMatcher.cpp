@@ -0,0 +1,349 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "IEBusEventMatcher.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+#include <utility>
+
+#include "IEBusText.hpp"
+
+namespace {
+
+auto constexpr ADDRESSES = 4096;
+auto constexpr CONTROLS = 16;
+// extra control and length rows for messages that ended before their control field
+auto constexpr NO_CONTROL = CONTROLS;
+// header bit and the NAK / parity error flags
+auto constexpr STATUSES = 8;
+auto constexpr LENGTHS = 256;
+auto constexpr NO_LENGTH = LENGTHS;
+auto constexpr BYTE_VALUES = 256;
+
+// "<hex>" or "<hex>/<mask>", a bare value compares all 12 bits
+auto parseAddress(std::string_view text, std::uint16_t& address, std::uint16_t& mask) -> bool {
+  auto const slash = text.find('/');
+  unsigned value = 0;
+  unsigned bits = 0xFFF;
+  if (not IEBusText::parseHex(text.substr(0, slash), 0xFFF, value) or (slash != std::string_view::npos and not IEBusText::parseHex(text.substr(slash + 1), 0xFFF, bits))) {
+    return false;
+  }
+  address = static_cast<std::uint16_t>(value & bits);
+  mask = static_cast<std::uint16_t>(bits);
+  return true;
+}
+
+auto parseNibble(char digit, std::uint8_t& value, std::uint8_t& mask) -> bool {
+  unsigned nibble = 0;
+  if (digit == '?') {
+    value = 0;
+    mask = 0;
+    return true;
+  }
+  if (not IEBusText::parseHex(std::string_view(&digit, 1), 0xF, nibble)) {
+    return false;
+  }
+  value = static_cast<std::uint8_t>(nibble);
+  mask = 0xF;
+  return true;
+}
+
+auto parsePattern(std::string_view text, std::vector<IEBusEventRule::BytePattern>& pattern) -> bool {
+  while (not text.empty()) {
+    auto const dot = text.find('.');
+    auto const byte = text.substr(0, dot);
+    if (byte.size() != 2) {
+      return false;
+    }
+
+    std::uint8_t high = 0, highMask = 0, low = 0, lowMask = 0;
+    if (not parseNibble(byte[0], high, highMask) or not parseNibble(byte[1], low, lowMask)) {
+      return false;
+    }
+    pattern.push_back({static_cast<std::uint8_t>(high << 4 | low), static_cast<std::uint8_t>(highMask << 4 | lowMask)});
+
+    text = dot == std::string_view::npos ? std::string_view() : text.substr(dot + 1);
+  }
+  return not pattern.empty();
+}
+
+auto parseCondition(std::string_view token, IEBusEventRule& rule) -> bool {
+  auto const equals = token.find('=');
+  auto const key = token.substr(0, equals);
+  auto const value = equals == std::string_view::npos ? std::string_view() : token.substr(equals + 1);
+
+  if (key == "nak" and value.empty()) {
+    rule.flags |= IEBusFlag::NAK;
+  } else if (key == "parity-error" and value.empty()) {
+    rule.flags |= IEBusFlag::PARITY_ERROR;
+  } else if (key == "broadcast" and value.empty()) {
+    rule.broadcast = true;
+  } else if (key == "individual" and value.empty()) {
+    rule.broadcast = false;
+  } else if (key == "master") {
+    return parseAddress(value, rule.master, rule.masterMask);
+  } else if (key == "slave") {
+    return parseAddress(value, rule.slave, rule.slaveMask);
+  } else if (key == "control") {
+    rule.controls = 0;
+    for (auto codes = value; not codes.empty();) {
+      auto const comma = codes.find(',');
+      unsigned code = 0;
+      if (not IEBusText::parseHex(codes.substr(0, comma), 0xF, code)) {
+        return false;
+      }
+      rule.controls |= static_cast<std::uint16_t>(1u << code);
+      codes = comma == std::string_view::npos ? std::string_view() : codes.substr(comma + 1);
+    }
+    return rule.controls != 0;
+  } else if (key == "data") {
+    return parsePattern(value, rule.data);
+  } else if (key == "length") {
+    unsigned length = 0;
+    if (not IEBusText::parseDecimal(value, 0xFF, length)) {
+      return false;
+    }
+    rule.length = static_cast<std::uint8_t>(length);
+  } else if (key == "rate") {
+    auto const slash = value.find('/');
+    if (slash == std::string_view::npos) {
+      return false;
+    }
+    auto const countText = value.substr(0, slash);
+    auto const windowText = std::string(value.substr(slash + 1));
+    unsigned count = 0;
+    if (not IEBusText::parseDecimal(countText, ~0u, count) or count == 0) {
+      return false;
+    }
+    rule.rateCount = count;
+    try {
+      std::size_t used = 0;
+      rule.rateWindowSeconds = std::stod(windowText, &used);
+      return used == windowText.size() and rule.rateWindowSeconds > 0.0;
+    } catch (std::exception const&) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+auto IEBusEventMatcher::add(IEBusEventRule rule) -> void {
+  m_rules.push_back(std::move(rule));
+}
+
+auto IEBusEventMatcher::load(std::istream& stream, std::string& error) -> bool {
+  auto lineNumber = 0;
+  for (std::string line; std::getline(stream, line);) {
+    lineNumber++;
+
+    line.erase(std::min(line.find('#'), line.size()));
+    std::istringstream tokens(line);
+
+    IEBusEventRule rule;
+    if (not(tokens >> rule.name)) {
+      continue;
+    }
+
+    for (std::string token; tokens >> token;) {
+      if (not parseCondition(token, rule)) {
+        error = "line " + std::to_string(lineNumber) + ": bad condition " + token;
+        return false;
+      }
+    }
+    add(std::move(rule));
+  }
+  return true;
+}
+
+auto IEBusEventMatcher::loadFile(std::string const& path, std::string& error) -> bool {
+  std::ifstream stream(path);
+  if (not stream) {
+    error = "cannot open " + path;
+    return false;
+  }
+  return load(stream, error);
+}
+
+auto IEBusEventMatcher::compile(double sampleRateHz) -> void {
+  m_words = (m_rules.size() + 63) / 64;
+
+  compileHeader();
+  compilePayload();
+
+  m_rateWindows.clear();
+  for (auto const& rule : m_rules) {
+    m_rateWindows.push_back(static_cast<std::uint64_t>(std::llround(rule.rateWindowSeconds * sampleRateHz)));
+  }
+  m_recentMatches.assign(m_rules.size(), {});
+  m_candidates.assign(m_words, 0);
+}
+
+auto IEBusEventMatcher::empty() const -> bool {
+  return m_rules.empty();
+}
+
+auto IEBusEventMatcher::getRule(std::uint32_t id) const -> IEBusEventRule const& {
+  return m_rules[id];
+}
+
+auto IEBusEventMatcher::match(IEBusMessage const& message, std::vector<std::uint32_t>& hits) -> void {
+  hits.clear();
+  if (m_words == 0) {
+    return;
+  }
+
+  auto const status = (message.header & 1u) << 2 | (message.flags & (IEBusFlag::NAK | IEBusFlag::PARITY_ERROR));
+  auto const master = bits(m_masterRules, message.master & 0xFFF);
+  auto const slave = bits(m_slaveRules, message.slave & 0xFFF);
+  auto const control = bits(m_controlRules, message.hasControl ? message.control & 0xF : NO_CONTROL);
+  auto const statusBits = bits(m_statusRules, status);
+  auto const length = bits(m_lengthRules, message.hasControl ? message.length : NO_LENGTH);
+
+  auto const candidates = m_candidates.data();
+  auto any = Bits{0};
+  for (std::size_t w = 0; w < m_words; w++) {
+    candidates[w] = master[w] & slave[w] & control[w] & statusBits[w] & length[w];
+    any |= candidates[w];
+  }
+
+  // one AND per payload byte narrows the candidates to the rules whose pattern still matches
+  auto const depth = std::min(message.data.size(), m_maxDepth);
+  for (std::size_t d = 0; d < depth and any != 0; d++) {
+    auto const alive = bits(m_payloadRules, d * BYTE_VALUES + message.data[d]);
+    any = 0;
+    for (std::size_t w = 0; w < m_words; w++) {
+      candidates[w] &= alive[w];
+      any |= candidates[w];
+    }
+  }
+  if (any == 0) {
+    return;
+  }
+
+  // a payload shorter than the pattern doesn't match it
+  auto const ended = bits(m_patternEnds, depth);
+  for (std::size_t w = 0; w < m_words; w++) {
+    for (auto word = candidates[w] & ended[w]; word != 0; word &= word - 1) {
+      auto const id = static_cast<std::uint32_t>(w * 64 + std::countr_zero(word));
+      if (passesRate(id, message.startSample)) {
+        hits.push_back(id);
+      }
+    }
+  }
+}
+
+auto IEBusEventMatcher::compileHeader() -> void {
+  m_masterRules.assign(ADDRESSES * m_words, 0);
+  m_slaveRules.assign(ADDRESSES * m_words, 0);
+  m_controlRules.assign((CONTROLS + 1) * m_words, 0);
+  m_statusRules.assign(STATUSES * m_words, 0);
+  m_lengthRules.assign((LENGTHS + 1) * m_words, 0);
+
+  for (std::size_t id = 0; id < m_rules.size(); id++) {
+    auto const& rule = m_rules[id];
+    auto const word = id / 64;
+    auto const bit = Bits{1} << (id % 64);
+
+    for (unsigned address = 0; address < ADDRESSES; address++) {
+      if ((address & rule.masterMask) == rule.master) {
+        bits(m_masterRules, address)[word] |= bit;
+      }
+      if ((address & rule.slaveMask) == rule.slave) {
+        bits(m_slaveRules, address)[word] |= bit;
+      }
+    }
+    for (unsigned control = 0; control < CONTROLS; control++) {
+      if (rule.controls & (1u << control)) {
+        bits(m_controlRules, control)[word] |= bit;
+      }
+    }
+    if (rule.controls == 0xFFFF) {
+      bits(m_controlRules, NO_CONTROL)[word] |= bit;
+    }
+    for (unsigned status = 0; status < STATUSES; status++) {
+      // the header bit is 0 for broadcasts
+      auto const broadcast = (status & 4u) == 0;
+      if ((status & rule.flags) == rule.flags and (not rule.broadcast or *rule.broadcast == broadcast)) {
+        bits(m_statusRules, status)[word] |= bit;
+      }
+    }
+    for (unsigned length = 0; length < LENGTHS; length++) {
+      if (not rule.length or *rule.length == length) {
+        bits(m_lengthRules, length)[word] |= bit;
+      }
+    }
+    if (not rule.length) {
+      bits(m_lengthRules, NO_LENGTH)[word] |= bit;
+    }
+  }
+}
+
+auto IEBusEventMatcher::compilePayload() -> void {
+  m_maxDepth = 0;
+  for (auto const& rule : m_rules) {
+    m_maxDepth = std::max(m_maxDepth, rule.data.size());
+  }
+
+  // a rule stays alive at depth d on every byte its pattern accepts there, and on any byte past its end
+  m_payloadRules.assign(m_maxDepth * BYTE_VALUES * m_words, 0);
+  m_patternEnds.assign((m_maxDepth + 1) * m_words, 0);
+  for (std::size_t id = 0; id < m_rules.size(); id++) {
+    auto const& pattern = m_rules[id].data;
+    auto const word = id / 64;
+    auto const bit = Bits{1} << (id % 64);
+
+    for (std::size_t depth = 0; depth < m_maxDepth; depth++) {
+      for (unsigned byte = 0; byte < BYTE_VALUES; byte++) {
+        if (depth >= pattern.size() or (byte & pattern[depth].mask) == pattern[depth].value) {
+          bits(m_payloadRules, depth * BYTE_VALUES + byte)[word] |= bit;
+        }
+      }
+    }
+    for (auto depth = pattern.size(); depth <= m_maxDepth; depth++) {
+      bits(m_patternEnds, depth)[word] |= bit;
+    }
+  }
+}
+
+auto IEBusEventMatcher::bits(std::vector<Bits>& table, std::size_t row) -> Bits* {
+  return table.data() + row * m_words;
+}
+
+auto IEBusEventMatcher::passesRate(std::uint32_t id, std::uint64_t sample) -> bool {
+  auto const count = m_rules[id].rateCount;
+  if (count <= 1) {
+    return true;
+  }
+
+  auto& recent = m_recentMatches[id];
+  recent.push_back(sample);
+  while (sample - recent.front() > m_rateWindows[id]) {
+    recent.pop_front();
+  }
+  if (recent.size() < count) {
+    return false;
+  }
+
+  recent.clear();
+  return true;
+}
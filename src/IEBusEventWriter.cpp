@@ -0,0 +1,47 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "IEBusEventWriter.hpp"
+
+#include <array>
+#include <cstdio>
+
+namespace {
+
+auto constexpr LINE_LENGTH = 64;
+
+} // namespace
+
+IEBusEventWriter::IEBusEventWriter(std::ostream& stream, IEBusEventMatcher& matcher, double sampleRateHz, std::uint64_t triggerSample)
+    : m_stream(stream), m_matcher(matcher), m_time{sampleRateHz, triggerSample} {
+  m_stream << "Start [s],End [s],Rule,Master,Slave,Control,Length,Data,NAK,Parity Error\n";
+}
+
+auto IEBusEventWriter::write(std::uint32_t rule, IEBusMessage const& message) -> void {
+  auto line = std::array<char, LINE_LENGTH>();
+  auto const lineLength = std::snprintf(line.data(), line.size(), "%.9f,%.9f,", m_time.toSeconds(message.startSample), m_time.toSeconds(message.endSample));
+  m_stream.write(line.data(), lineLength);
+  IEBusText::writeCsvText(m_stream, m_matcher.getRule(rule).name);
+  m_stream << ',';
+
+  IEBusText::writeMessageColumns(m_stream, message);
+  m_stream << '\n';
+}
+
+auto IEBusEventWriter::onMessage(IEBusMessage const& message) -> void {
+  m_matcher.match(message, m_hits);
+  for (auto const rule : m_hits) {
+    write(rule, message);
+  }
+}
@@ -0,0 +1,212 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "IEBusMessageDictionary.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// FNV-1a
+auto constexpr HASH_OFFSET = std::uint64_t{14695981039346656037ull};
+auto constexpr HASH_PRIME = std::uint64_t{1099511628211ull};
+
+auto mix(std::uint64_t hash, std::uint64_t value) -> std::uint64_t {
+  return (hash ^ value) * HASH_PRIME;
+}
+
+// dictionary entries allowed on top of twice the retained records before it is rebuilt
+auto constexpr COMPACT_SLACK = 4096;
+
+} // namespace
+
+auto IEBusMessageDictionary::intern(IEBusMessage const& message) -> std::uint32_t {
+  auto const messageHash = hash(message);
+
+  auto const [first, last] = m_index.equal_range(messageHash);
+  for (auto it = first; it != last; ++it) {
+    if (matches(m_entries[it->second], message)) {
+      return it->second;
+    }
+  }
+
+  Entry entry;
+  entry.hash = messageHash;
+  entry.payloadOffset = static_cast<std::uint32_t>(m_payloads.size());
+  entry.payloadLength = static_cast<std::uint16_t>(message.data.size());
+  entry.master = message.master;
+  entry.slave = message.slave;
+  entry.header = message.header;
+  entry.control = message.control;
+  entry.length = message.length;
+  entry.hasControl = message.hasControl;
+
+  auto const id = static_cast<std::uint32_t>(m_entries.size());
+  m_entries.push_back(entry);
+  m_payloads.insert(m_payloads.end(), message.data.begin(), message.data.end());
+  m_index.emplace(messageHash, id);
+  return id;
+}
+
+auto IEBusMessageDictionary::clear() -> void {
+  m_entries.clear();
+  m_payloads.clear();
+  m_index.clear();
+}
+
+auto IEBusMessageDictionary::size() const -> std::size_t {
+  return m_entries.size();
+}
+
+auto IEBusMessageDictionary::getEntry(std::uint32_t id) const -> Entry const& {
+  return m_entries[id];
+}
+
+auto IEBusMessageDictionary::getPayload(std::uint32_t id) const -> std::span<std::uint8_t const> {
+  auto const& entry = m_entries[id];
+  return {m_payloads.data() + entry.payloadOffset, entry.payloadLength};
+}
+
+auto IEBusMessageDictionary::expand(std::uint32_t id, IEBusMessage& message) const -> void {
+  auto const& entry = m_entries[id];
+  auto const payload = getPayload(id);
+
+  message.header = entry.header;
+  message.master = entry.master;
+  message.slave = entry.slave;
+  message.control = entry.control;
+  message.length = entry.length;
+  message.hasControl = entry.hasControl;
+  message.data.assign(payload.begin(), payload.end());
+}
+
+auto IEBusMessageDictionary::streamKey(IEBusMessage const& message) -> std::uint32_t {
+  return (std::uint32_t{message.master} << 18) | (std::uint32_t{message.slave} << 6) | (std::uint32_t{message.control} << 2) | (message.hasControl ? 2u : 0u) |
+         (message.isBroadcast() ? 1u : 0u);
+}
+
+auto IEBusMessageDictionary::hash(IEBusMessage const& message) -> std::uint64_t {
+  auto value = HASH_OFFSET;
+  value = mix(value, message.header);
+  value = mix(value, message.master);
+  value = mix(value, message.slave);
+  value = mix(value, message.control);
+  value = mix(value, message.length);
+  value = mix(value, message.hasControl ? 1 : 0);
+  for (auto const byte : message.data) {
+    value = mix(value, byte);
+  }
+  return value;
+}
+
+auto IEBusMessageDictionary::matches(Entry const& entry, IEBusMessage const& message) const -> bool {
+  if (entry.master != message.master or entry.slave != message.slave or entry.header != message.header or entry.control != message.control or
+      entry.length != message.length or entry.hasControl != message.hasControl or entry.payloadLength != message.data.size()) {
+    return false;
+  }
+
+  return std::equal(message.data.begin(), message.data.end(), m_payloads.begin() + entry.payloadOffset);
+}
+
+auto IEBusMessageStore::setRetention(std::uint64_t maxMessages, std::uint64_t maxSamples) -> void {
+  m_maxMessages = maxMessages;
+  m_maxSamples = maxSamples;
+  evict();
+}
+
+auto IEBusMessageStore::add(IEBusMessage const& message) -> std::uint64_t {
+  Record record;
+  record.startSample = message.startSample;
+  record.endSample = message.endSample;
+  record.id = m_dictionary.intern(message);
+  record.flags = message.flags;
+
+  m_records.push_back(record);
+  auto const index = getEndIndex() - 1;
+
+  evict();
+  return index;
+}
+
+auto IEBusMessageStore::clear() -> void {
+  m_dictionary.clear();
+  m_records.clear();
+  m_firstIndex = 0;
+}
+
+auto IEBusMessageStore::size() const -> std::size_t {
+  return m_records.size();
+}
+
+auto IEBusMessageStore::getFirstIndex() const -> std::uint64_t {
+  return m_firstIndex;
+}
+
+auto IEBusMessageStore::getEndIndex() const -> std::uint64_t {
+  return m_firstIndex + m_records.size();
+}
+
+auto IEBusMessageStore::contains(std::uint64_t index) const -> bool {
+  return index >= m_firstIndex and index < getEndIndex();
+}
+
+auto IEBusMessageStore::getRecord(std::uint64_t index) const -> Record const& {
+  return m_records[index - m_firstIndex];
+}
+
+auto IEBusMessageStore::getDictionary() const -> IEBusMessageDictionary const& {
+  return m_dictionary;
+}
+
+auto IEBusMessageStore::get(std::uint64_t index, IEBusMessage& message) const -> void {
+  auto const& record = getRecord(index);
+
+  m_dictionary.expand(record.id, message);
+  message.startSample = record.startSample;
+  message.endSample = record.endSample;
+  message.flags = record.flags;
+}
+
+auto IEBusMessageStore::evict() -> void {
+  if (m_records.empty()) {
+    return;
+  }
+
+  auto const newest = m_records.back().startSample;
+  auto const expired = [&](Record const& record) { return m_maxSamples != 0 and newest - record.startSample > m_maxSamples; };
+
+  auto evicted = false;
+  while (not m_records.empty() and ((m_maxMessages != 0 and m_records.size() > m_maxMessages) or expired(m_records.front()))) {
+    m_records.pop_front();
+    m_firstIndex++;
+    evicted = true;
+  }
+
+  if (evicted and m_dictionary.size() > m_records.size() * 2 + COMPACT_SLACK) {
+    compact();
+  }
+}
+
+auto IEBusMessageStore::compact() -> void {
+  IEBusMessageDictionary dictionary;
+  IEBusMessage message;
+
+  for (auto& record : m_records) {
+    m_dictionary.expand(record.id, message);
+    record.id = dictionary.intern(message);
+  }
+
+  m_dictionary = std::move(dictionary);
+}
@@ -0,0 +1,107 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "IEBusMessageWriter.hpp"
+
+#include <array>
+#include <bit>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+static_assert(std::endian::native == std::endian::little, "binary export is written in host byte order");
+
+auto constexpr BINARY_MAGIC = "IEBUSMSG";
+auto constexpr BINARY_VERSION = std::uint32_t{2};
+// record flags beyond IEBusFlag, since version 2
+auto constexpr RECORD_HAS_CONTROL = std::uint8_t{1 << 2};
+
+auto constexpr LINE_LENGTH = 64;
+
+template <typename T> auto put(char*& out, T value) -> void {
+  std::memcpy(out, &value, sizeof(value));
+  out += sizeof(value);
+}
+
+} // namespace
+
+IEBusMessageWriter::IEBusMessageWriter(std::ostream& stream, Format format, double sampleRateHz, std::uint64_t triggerSample, IEBusDissectorRegistry const* dissectors)
+    : m_stream(stream), m_format(format), m_time{sampleRateHz, triggerSample}, m_dissectors(dissectors) {
+  if (m_format == Format::Csv) {
+    m_stream << "Start [s],End [s],Header,Master,Slave,Control,Length,Data,NAK,Parity Error" << (m_dissectors ? ",Command,Fields\n" : "\n");
+    return;
+  }
+
+  auto header = std::array<char, 24>();
+  auto out = header.data();
+  std::memcpy(out, BINARY_MAGIC, 8);
+  out += 8;
+  put(out, BINARY_VERSION);
+  put(out, std::uint32_t{0});
+  put(out, m_time.sampleRateHz);
+  m_stream.write(header.data(), header.size());
+}
+
+auto IEBusMessageWriter::write(IEBusMessage const& message) -> void {
+  if (m_format == Format::Csv) {
+    writeCsv(message);
+  } else {
+    writeBinary(message);
+  }
+}
+
+auto IEBusMessageWriter::onMessage(IEBusMessage const& message) -> void {
+  write(message);
+}
+
+auto IEBusMessageWriter::writeCsv(IEBusMessage const& message) -> void {
+  auto line = std::array<char, LINE_LENGTH>();
+  auto const lineLength =
+      std::snprintf(line.data(), line.size(), "%.9f,%.9f,%u,", m_time.toSeconds(message.startSample), m_time.toSeconds(message.endSample), message.header);
+
+  m_stream.write(line.data(), lineLength);
+  IEBusText::writeMessageColumns(m_stream, message);
+
+  if (m_dissectors) {
+    auto const command = m_dissectors->find(message);
+    if (command) {
+      IEBusDissectorRegistry::formatFields(*command, message, m_fields);
+      m_stream << ',';
+      IEBusText::writeCsvText(m_stream, command->name);
+      m_stream << ',';
+      IEBusText::writeCsvText(m_stream, m_fields);
+    } else {
+      m_stream << ",,";
+    }
+  }
+  m_stream << '\n';
+}
+
+auto IEBusMessageWriter::writeBinary(IEBusMessage const& message) -> void {
+  auto record = std::array<char, 26>();
+  auto out = record.data();
+  put(out, message.startSample);
+  put(out, message.endSample);
+  put(out, message.master);
+  put(out, message.slave);
+  put(out, message.header);
+  put(out, message.control);
+  put(out, message.length);
+  put(out, static_cast<std::uint8_t>(message.flags | (message.hasControl ? RECORD_HAS_CONTROL : 0)));
+  put(out, static_cast<std::uint16_t>(message.data.size()));
+
+  m_stream.write(record.data(), out - record.data());
+  m_stream.write(reinterpret_cast<char const*>(message.data.data()), static_cast<std::streamsize>(message.data.size()));
+}
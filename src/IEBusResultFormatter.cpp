@@ -0,0 +1,214 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "IEBusResultFormatter.hpp"
+
+#include <AnalyzerHelpers.h>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+auto constexpr NUMBER_STRINGS = 128;
+
+auto constexpr WIDTHS = std::array<U32, 4>{1, 4, 8, 12};
+
+struct Label {
+  char const* shortName;
+  char const* mediumName;
+  char const* longName;
+  bool hasValue;
+  bool hasParity;
+  bool hasAck;
+};
+
+auto constexpr START_LABEL = Label{"St", "Start", "Start bit", false, false, false};
+auto constexpr HEADER_LABEL = Label{"H", "Header", "Header bit", true, false, false};
+auto constexpr MASTER_LABEL = Label{"M", "Master", "Master addr", true, true, false};
+auto constexpr SLAVE_LABEL = Label{"S", "Slave", "Slave addr", true, true, true};
+auto constexpr CONTROL_LABEL = Label{"C", "Control", "Control code", true, true, true};
+auto constexpr LENGTH_LABEL = Label{"L", "Length", "Length field", true, true, true};
+auto constexpr DATA_LABEL = Label{"D", "Data", "Data byte", true, true, true};
+
+auto getLabel(U64 type) -> Label const& {
+  switch (type) {
+  case IEBusFieldType::START:
+    return START_LABEL;
+  case IEBusFieldType::HEADER:
+    return HEADER_LABEL;
+  case IEBusFieldType::MASTER:
+    return MASTER_LABEL;
+  case IEBusFieldType::SLAVE:
+    return SLAVE_LABEL;
+  case IEBusFieldType::CONTROL:
+    return CONTROL_LABEL;
+  case IEBusFieldType::LENGTH:
+    return LENGTH_LABEL;
+  default:
+    return DATA_LABEL;
+  }
+}
+
+auto getWidthIndex(U64 type) -> std::size_t {
+  switch (type) {
+  case IEBusFieldType::START:
+  case IEBusFieldType::HEADER:
+    return 0;
+  case IEBusFieldType::CONTROL:
+    return 1;
+  case IEBusFieldType::MASTER:
+  case IEBusFieldType::SLAVE:
+    return 3;
+  default:
+    return 2;
+  }
+}
+
+// appends to a fixed buffer, silently truncating
+class TextBuilder {
+public:
+  explicit TextBuilder(std::array<char, IEBusResultFormatter::TEXT_LENGTH>& text) : m_text(text) {
+    m_text[0] = '\0';
+  }
+
+public:
+  auto append(char const* part) -> TextBuilder& {
+    auto const length = std::min(std::strlen(part), m_text.size() - 1 - m_length);
+    std::memcpy(m_text.data() + m_length, part, length);
+    m_length += length;
+    m_text[m_length] = '\0';
+    return *this;
+  }
+
+private:
+  std::array<char, IEBusResultFormatter::TEXT_LENGTH>& m_text;
+  std::size_t m_length = 0;
+};
+
+} // namespace
+
+auto IEBusResultFormatter::format(Frame const& frame, DisplayBase displayBase, Strings& strings) -> void {
+  auto const& label = getLabel(frame.mData2);
+  auto const nak = (frame.mFlags & IEBusFlag::NAK) != 0;
+  auto const parityError = (frame.mFlags & IEBusFlag::PARITY_ERROR) != 0;
+
+  TextBuilder(strings.shortText).append(nak ? "NAK" : label.shortName);
+
+  TextBuilder medium(strings.mediumText);
+  TextBuilder full(strings.longText);
+  medium.append(label.mediumName);
+  full.append(label.longName);
+
+  if (label.hasValue) {
+    auto const number = getNumberString(frame.mData1, static_cast<U8>(frame.mData2), displayBase);
+    medium.append(" ").append(number);
+    full.append(" ").append(number);
+  }
+
+  if (frame.mData2 == IEBusFieldType::HEADER) {
+    full.append(frame.mData1 ? " (individual)" : " (broadcast)");
+  }
+  if (label.hasParity) {
+    full.append(parityError ? " parity error" : " parity OK");
+  }
+  if (label.hasAck) {
+    full.append(nak ? ", NAK" : ", ACK");
+  }
+
+  if (nak) {
+    medium.append(" NAK");
+  } else if (parityError) {
+    medium.append(" parity error");
+  }
+}
+
+auto IEBusResultFormatter::formatMessage(IEBusMessage const& message, DisplayBase displayBase, Strings& strings, IEBusCommand const* command) -> void {
+  auto const nak = (message.flags & IEBusFlag::NAK) != 0;
+  auto const parityError = (message.flags & IEBusFlag::PARITY_ERROR) != 0;
+
+  auto const master = getNumberString(message.master, IEBusFieldType::MASTER, displayBase);
+  auto const slave = getNumberString(message.slave, IEBusFieldType::SLAVE, displayBase);
+  auto const control = getNumberString(message.control, IEBusFieldType::CONTROL, displayBase);
+  auto const length = getNumberString(message.length, IEBusFieldType::LENGTH, displayBase);
+  auto const target = message.isBroadcast() ? " >> " : " > ";
+
+  TextBuilder(strings.shortText).append(master).append(message.isBroadcast() ? ">>" : ">").append(slave);
+
+  TextBuilder medium(strings.mediumText);
+  medium.append(master).append(target).append(slave);
+
+  TextBuilder full(strings.longText);
+  full.append("Master ").append(master).append(target).append("Slave ").append(slave);
+
+  // the slave NAKed its address, control and length never followed
+  if (message.hasControl) {
+    medium.append(" ").append(control).append(" [").append(length).append("]");
+    full.append(" control ").append(control).append(" length ").append(length);
+  }
+
+  if (nak) {
+    medium.append(" NAK");
+    full.append(" NAK");
+  } else if (parityError) {
+    medium.append(" parity error");
+    full.append(" parity error");
+  }
+
+  if (command) {
+    std::string fields;
+    IEBusDissectorRegistry::formatFields(*command, message, fields);
+
+    medium.append(" ").append(command->name.c_str());
+    full.append(" ").append(command->name.c_str());
+    if (not fields.empty()) {
+      full.append(" (").append(fields.c_str()).append(")");
+    }
+  } else if (auto const name = message.hasControl ? IEBusDissectorRegistry::getControlName(message.control) : nullptr) {
+    // a plain label, looked up only when the bubble is drawn
+    medium.append(" ").append(name);
+    full.append(" ").append(name);
+  }
+
+  if (not message.data.empty()) {
+    full.append(":");
+    for (auto const byte : message.data) {
+      full.append(" ").append(getNumberString(byte, IEBusFieldType::DATA, displayBase));
+    }
+  }
+}
+
+auto IEBusResultFormatter::getNumberString(U64 value, U8 type, DisplayBase displayBase) -> char const* {
+  auto const& numbers = getTables(displayBase).byWidth[getWidthIndex(type)];
+  return value < numbers.size() ? numbers[value].c_str() : "?";
+}
+
+auto IEBusResultFormatter::getTables(DisplayBase displayBase) -> NumberTables const& {
+  auto& tables = m_tables[displayBase];
+
+  std::call_once(tables.built, [&] {
+    auto numberString = std::array<char, NUMBER_STRINGS>();
+
+    for (std::size_t i = 0; i < WIDTHS.size(); i++) {
+      auto& numbers = tables.byWidth[i];
+      numbers.resize(std::size_t{1} << WIDTHS[i]);
+
+      for (U64 value = 0; value < numbers.size(); value++) {
+        AnalyzerHelpers::GetNumberString(value, displayBase, WIDTHS[i], numberString.data(), NUMBER_STRINGS);
+        numbers[value] = numberString.data();
+      }
+    }
+  });
+
+  return tables;
+}
@@ -0,0 +1,183 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "IEBusSignalQuality.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+auto constexpr LINE_LENGTH = 256;
+auto constexpr KIND_NAMES = std::array{"start", "one", "zero", "ack"};
+
+// the histograms span twice the decoder's tolerance around each nominal width
+auto makeRange(std::uint64_t low, std::uint64_t high) -> std::pair<std::uint64_t, std::uint64_t> {
+  return {low, std::max<std::uint64_t>(1, (high - low + IEBusSignalQuality::BINS - 1) / IEBusSignalQuality::BINS)};
+}
+
+} // namespace
+
+auto IEBusSignalQuality::Accumulator::add(std::uint64_t width, std::size_t bin, bool near) -> void {
+  min = count == 0 ? width : std::min(min, width);
+  max = count == 0 ? width : std::max(max, width);
+  count++;
+
+  // Welford's update
+  auto const delta = static_cast<double>(width) - mean;
+  mean += delta / static_cast<double>(count);
+  m2 += delta * (static_cast<double>(width) - mean);
+
+  nearThreshold += near ? 1 : 0;
+  histogram[bin]++;
+}
+
+auto IEBusSignalQuality::Accumulator::merge(Accumulator const& other) -> void {
+  if (other.count == 0) {
+    return;
+  }
+  if (count == 0) {
+    *this = other;
+    return;
+  }
+
+  // Chan et al. pairwise combination
+  auto const total = static_cast<double>(count + other.count);
+  auto const delta = other.mean - mean;
+  mean += delta * static_cast<double>(other.count) / total;
+  m2 += other.m2 + delta * delta * static_cast<double>(count) * static_cast<double>(other.count) / total;
+
+  min = std::min(min, other.min);
+  max = std::max(max, other.max);
+  count += other.count;
+  nearThreshold += other.nearThreshold;
+  for (std::size_t i = 0; i < histogram.size(); i++) {
+    histogram[i] += other.histogram[i];
+  }
+}
+
+auto IEBusSignalQuality::Accumulator::variance() const -> double {
+  return count > 1 ? m2 / static_cast<double>(count - 1) : 0.0;
+}
+
+IEBusSignalQuality::IEBusSignalQuality(IEBusTiming const& timing) {
+  setTiming(timing);
+}
+
+auto IEBusSignalQuality::setTiming(IEBusTiming const& timing) -> void {
+  // the same nominal widths and tolerances as the decoder
+  auto const start = timing.startBitWidth;
+  auto const startTolerance = timing.startBitWidth / 10;
+  auto const one = timing.dataBitWidth / 2;
+  auto const zero = static_cast<std::uint64_t>(static_cast<double>(timing.dataBitWidth) * 0.875);
+  auto const tolerance = timing.dataBitWidth / 10;
+
+  auto const set = [&](IEBusPulse::Kind kind, std::uint64_t low, std::uint64_t high) {
+    auto const [from, binWidth] = makeRange(low, high);
+    m_ranges[static_cast<std::size_t>(kind)] = {from, binWidth};
+  };
+  set(IEBusPulse::Kind::Start, start - std::min(start, 2 * startTolerance), start + 2 * startTolerance);
+  set(IEBusPulse::Kind::One, one - std::min(one, 2 * tolerance), one + 2 * tolerance);
+  set(IEBusPulse::Kind::Zero, zero - std::min(zero, 2 * tolerance), zero + 2 * tolerance);
+  // ACK bits are ones or zeros, one histogram covers both
+  set(IEBusPulse::Kind::Ack, one - std::min(one, 2 * tolerance), zero + 2 * tolerance);
+
+  m_nodes.clear();
+  m_masterPending = {};
+  m_slavePending = {};
+}
+
+auto IEBusSignalQuality::onPulse(IEBusPulse const& pulse) -> void {
+  if (pulse.kind == IEBusPulse::Kind::Start) {
+    // whatever was pending belonged to an abandoned message
+    m_masterPending = {};
+    m_slavePending = {};
+  }
+  if (not pulse.driven) {
+    return;
+  }
+
+  auto& pending = pulse.fromSlave ? m_slavePending : m_masterPending;
+  pending[static_cast<std::size_t>(pulse.kind)].add(pulse.width, getBin(pulse.kind, pulse.width), pulse.nearThreshold);
+}
+
+auto IEBusSignalQuality::onMessage(IEBusMessage const& message) -> void {
+  mergeInto(m_nodes[message.master], m_masterPending);
+  // a broadcast has no single receiver driving its ACK bits, and a slave that NAKed its address drove
+  // nothing at all, so a slave that does not exist never shows up
+  auto const drove = std::ranges::any_of(m_slavePending, [](Accumulator const& accumulator) { return accumulator.count > 0; });
+  if (message.isBroadcast() or not drove) {
+    m_slavePending = {};
+  } else {
+    mergeInto(m_nodes[message.slave], m_slavePending);
+  }
+}
+
+auto IEBusSignalQuality::write(std::ostream& stream, double sampleRateHz) const -> void {
+  auto const toUs = [&](double samples) { return samples * 1000000.0 / sampleRateHz; };
+
+  std::vector<std::uint16_t> nodes;
+  nodes.reserve(m_nodes.size());
+  for (auto const& [node, accumulators] : m_nodes) {
+    nodes.push_back(node);
+  }
+  std::ranges::sort(nodes);
+
+  stream << "Node,Kind,Count,Min [us],Max [us],Mean [us],Std Dev [us],Near Threshold,Histogram From [us],Bin Width [us],Below,Histogram,Above\n";
+
+  std::string bins;
+  for (auto const node : nodes) {
+    auto const& accumulators = m_nodes.at(node);
+    for (std::size_t kind = 0; kind < KINDS; kind++) {
+      auto const& accumulator = accumulators[kind];
+      if (accumulator.count == 0) {
+        continue;
+      }
+
+      bins.clear();
+      for (std::size_t i = 1; i <= BINS; i++) {
+        bins += i == 1 ? "" : " ";
+        bins += std::to_string(accumulator.histogram[i]);
+      }
+
+      auto const& range = m_ranges[kind];
+      auto line = std::array<char, LINE_LENGTH>();
+      auto const lineLength = std::snprintf(line.data(), line.size(), "0x%03X,%s,%llu,%.3f,%.3f,%.3f,%.3f,%llu,%.3f,%.3f,%llu,", node, KIND_NAMES[kind],
+                                            static_cast<unsigned long long>(accumulator.count), toUs(static_cast<double>(accumulator.min)),
+                                            toUs(static_cast<double>(accumulator.max)), toUs(accumulator.mean), toUs(std::sqrt(accumulator.variance())),
+                                            static_cast<unsigned long long>(accumulator.nearThreshold), toUs(static_cast<double>(range.from)),
+                                            toUs(static_cast<double>(range.binWidth)), static_cast<unsigned long long>(accumulator.histogram.front()));
+      stream.write(line.data(), lineLength);
+      stream << bins << ',' << accumulator.histogram.back() << '\n';
+    }
+  }
+}
+
+auto IEBusSignalQuality::getBin(IEBusPulse::Kind kind, std::uint64_t width) const -> std::size_t {
+  auto const& range = m_ranges[static_cast<std::size_t>(kind)];
+  if (width < range.from) {
+    return 0;
+  }
+  return std::min<std::size_t>((width - range.from) / range.binWidth + 1, BINS + 1);
+}
+
+auto IEBusSignalQuality::mergeInto(Accumulators& node, Accumulators& pending) -> void {
+  for (std::size_t kind = 0; kind < KINDS; kind++) {
+    node[kind].merge(pending[kind]);
+  }
+  pending = {};
+}
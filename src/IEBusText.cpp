@@ -0,0 +1,96 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "IEBusText.hpp"
+
+#include <array>
+#include <charconv>
+#include <cstdio>
+
+namespace {
+
+// "0x190,0x1FF,0xF,255,"
+auto constexpr ADDRESS_COLUMNS_LENGTH = 32;
+
+auto constexpr CONTROL_TEXTS = std::array{"0x0", "0x1", "0x2", "0x3", "0x4", "0x5", "0x6", "0x7", "0x8", "0x9", "0xA", "0xB", "0xC", "0xD", "0xE", "0xF"};
+
+} // namespace
+
+auto IEBusTimeBase::toSeconds(std::uint64_t sample) const -> double {
+  return (static_cast<double>(sample) - static_cast<double>(triggerSample)) / sampleRateHz;
+}
+
+auto IEBusText::formatHexBytes(std::span<std::uint8_t const> bytes, std::span<char> out) -> std::size_t {
+  auto constexpr DIGITS = "0123456789ABCDEF";
+
+  std::size_t length = 0;
+  for (auto const byte : bytes) {
+    auto const separator = length == 0 ? 0 : 1;
+    if (length + separator + 2 > out.size()) {
+      break;
+    }
+    if (separator) {
+      out[length++] = ' ';
+    }
+    out[length++] = DIGITS[byte >> 4];
+    out[length++] = DIGITS[byte & 0xF];
+  }
+  return length;
+}
+
+auto IEBusText::writeMessageColumns(std::ostream& stream, IEBusMessage const& message) -> void {
+  auto line = std::array<char, ADDRESS_COLUMNS_LENGTH + HEX_BYTES_LENGTH + 8>();
+  // control and length stay empty when the slave NAKed its address
+  auto length = static_cast<std::size_t>(
+      message.hasControl ? std::snprintf(line.data(), ADDRESS_COLUMNS_LENGTH, "0x%03X,0x%03X,0x%X,%u,", message.master, message.slave, message.control, message.length)
+                         : std::snprintf(line.data(), ADDRESS_COLUMNS_LENGTH, "0x%03X,0x%03X,,,", message.master, message.slave));
+
+  length += formatHexBytes(message.data, std::span(line).subspan(length, HEX_BYTES_LENGTH));
+  line[length++] = ',';
+  line[length++] = (message.flags & IEBusFlag::NAK) ? '1' : '0';
+  line[length++] = ',';
+  line[length++] = (message.flags & IEBusFlag::PARITY_ERROR) ? '1' : '0';
+  stream.write(line.data(), static_cast<std::streamsize>(length));
+}
+
+auto IEBusText::formatControl(std::uint8_t control, bool hasControl) -> char const* {
+  return hasControl ? CONTROL_TEXTS[control & 0xF] : "";
+}
+
+auto IEBusText::writeCsvText(std::ostream& stream, std::string_view text) -> void {
+  if (text.find_first_of(",\"\r\n") == std::string_view::npos) {
+    stream << text;
+    return;
+  }
+
+  // RFC 4180: the text goes in quotes, with every quote inside doubled
+  stream << '"';
+  for (auto const c : text) {
+    if (c == '"') {
+      stream << '"';
+    }
+    stream << c;
+  }
+  stream << '"';
+}
+
+auto IEBusText::parseHex(std::string_view text, unsigned max, unsigned& value) -> bool {
+  auto const [end, error] = std::from_chars(text.data(), text.data() + text.size(), value, 16);
+  return error == std::errc() and end == text.data() + text.size() and value <= max;
+}
+
+auto IEBusText::parseDecimal(std::string_view text, unsigned max, unsigned& value) -> bool {
+  auto const [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+  return error == std::errc() and end == text.data() + text.size() and value <= max;
+}
@@ -0,0 +1,194 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "IEBusTimingDetector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+
+auto constexpr BIN_COUNT = 256;
+// empty bins allowed inside one cluster
+auto constexpr CLUSTER_GAP = 2;
+// clusters smaller than this share of all pulses are glitches
+auto constexpr MIN_CLUSTER_SHARE = 0.001;
+auto constexpr MIN_PULSES = 64;
+
+// the decoder expects a one bit at 1/2 and a zero bit at 7/8 of the bit width
+auto constexpr ONE_BIT_RATIO = 0.5;
+auto constexpr ZERO_BIT_RATIO = 0.875;
+
+struct Cluster {
+  std::size_t count = 0;
+  double sum = 0.0;
+
+  [[nodiscard]] auto mean() const -> double {
+    return sum / static_cast<double>(count);
+  }
+};
+
+} // namespace
+
+IEBusTimingDetector::IEBusTimingDetector(std::size_t maxEdges) : m_maxEdges(maxEdges) {
+  m_widths.reserve(maxEdges / 2);
+}
+
+auto IEBusTimingDetector::addEdge(std::uint64_t sample, bool high) -> bool {
+  if (high) {
+    m_riseSample = sample;
+  } else if (m_riseSample) {
+    m_widths.push_back(sample - *m_riseSample);
+  }
+
+  return ++m_edges < m_maxEdges;
+}
+
+auto IEBusTimingDetector::scan(IEBusEdgeSource& source) -> void {
+  while (source.isEdgeAvailable() and source.advanceToNextEdge()) {
+    if (not addEdge(source.getSampleNumber(), source.isHigh())) {
+      return;
+    }
+  }
+}
+
+auto IEBusTimingDetector::detect() const -> std::optional<IEBusDetectedTiming> {
+  if (m_widths.size() < MIN_PULSES) {
+    return std::nullopt;
+  }
+
+  // size the histogram from the longest pulses that are not outliers
+  auto sorted = m_widths;
+  auto const top = sorted.begin() + static_cast<std::ptrdiff_t>(static_cast<double>(sorted.size() - 1) * 0.999);
+  std::nth_element(sorted.begin(), top, sorted.end());
+  auto const range = std::max<std::uint64_t>(*top * 5 / 4, BIN_COUNT);
+  auto const binWidth = (range + BIN_COUNT - 1) / BIN_COUNT;
+
+  auto bins = std::array<Cluster, BIN_COUNT>();
+  for (auto const width : m_widths) {
+    if (width < range) {
+      auto& bin = bins[width / binWidth];
+      bin.count++;
+      bin.sum += static_cast<double>(width);
+    }
+  }
+
+  // merge neighbouring bins into clusters, ordered by width
+  auto const minCount = std::max<std::size_t>(2, static_cast<std::size_t>(static_cast<double>(m_widths.size()) * MIN_CLUSTER_SHARE));
+  std::vector<Cluster> clusters;
+  auto current = Cluster();
+  auto gap = 0;
+  for (auto const& bin : bins) {
+    if (bin.count > 0) {
+      current.count += bin.count;
+      current.sum += bin.sum;
+      gap = 0;
+    } else if (current.count > 0 and ++gap > CLUSTER_GAP) {
+      if (current.count >= minCount) {
+        clusters.push_back(current);
+      }
+      current = Cluster();
+      gap = 0;
+    }
+  }
+  if (current.count >= minCount) {
+    clusters.push_back(current);
+  }
+
+  if (clusters.size() < 3) {
+    return std::nullopt;
+  }
+
+  // the data bits and the start bit are separated by the widest gap between neighbouring clusters that
+  // leaves at least two clusters below it, whatever the bit rate
+  std::size_t split = 2;
+  for (auto i = split + 1; i < clusters.size(); i++) {
+    if (clusters[i].mean() * clusters[split - 1].mean() > clusters[split].mean() * clusters[i - 1].mean()) {
+      split = i;
+    }
+  }
+
+  // the busiest cluster above the gap is the start bit, the two busiest below it the data bits
+  auto const start = *std::ranges::max_element(clusters.begin() + static_cast<std::ptrdiff_t>(split), clusters.end(), {}, &Cluster::count);
+  clusters.resize(split);
+
+  std::ranges::partial_sort(clusters, clusters.begin() + 2, std::ranges::greater{}, &Cluster::count);
+  auto const one = std::min(clusters[0].mean(), clusters[1].mean());
+  auto const zero = std::max(clusters[0].mean(), clusters[1].mean());
+
+  auto const ratio = zero / one;
+  if (ratio < 1.2 or ratio > 2.5) {
+    return std::nullopt;
+  }
+
+  IEBusDetectedTiming detected;
+  detected.startWidth = start.mean();
+  detected.oneWidth = one;
+  detected.zeroWidth = zero;
+  detected.pulses = m_widths.size();
+  detected.timing.startBitWidth = static_cast<std::uint64_t>(std::llround(start.mean()));
+  detected.timing.dataBitWidth = static_cast<std::uint64_t>(std::llround((one / ONE_BIT_RATIO + zero / ZERO_BIT_RATIO) / 2.0));
+  return detected;
+}
+
+IEBusPrefetchEdgeSource::IEBusPrefetchEdgeSource(IEBusEdgeSource& source) : m_source(source) {
+}
+
+auto IEBusPrefetchEdgeSource::prefetch(std::size_t maxEdges) -> void {
+  if (m_edges.empty()) {
+    m_initialSample = m_source.getSampleNumber();
+    m_initialHigh = m_source.isHigh();
+  }
+  m_edges.reserve(maxEdges);
+
+  while (m_edges.size() < maxEdges and m_source.isEdgeAvailable() and m_source.advanceToNextEdge()) {
+    m_edges.push_back(m_source.getSampleNumber());
+  }
+}
+
+auto IEBusPrefetchEdgeSource::isInitialHigh() const -> bool {
+  return m_initialHigh;
+}
+
+auto IEBusPrefetchEdgeSource::getEdges() const -> std::span<std::uint64_t const> {
+  return m_edges;
+}
+
+auto IEBusPrefetchEdgeSource::getSampleNumber() -> std::uint64_t {
+  // once the buffer is replayed the wrapped source sits on the same edge
+  if (m_position >= m_edges.size()) {
+    return m_source.getSampleNumber();
+  }
+  return m_position == 0 ? m_initialSample : m_edges[m_position - 1];
+}
+
+auto IEBusPrefetchEdgeSource::isHigh() -> bool {
+  if (m_position >= m_edges.size()) {
+    return m_source.isHigh();
+  }
+  return m_initialHigh != (m_position % 2 == 1);
+}
+
+auto IEBusPrefetchEdgeSource::isEdgeAvailable() -> bool {
+  return m_position < m_edges.size() or m_source.isEdgeAvailable();
+}
+
+auto IEBusPrefetchEdgeSource::advanceToNextEdge() -> bool {
+  if (m_position < m_edges.size()) {
+    m_position++;
+    return true;
+  }
+  return m_source.advanceToNextEdge();
+}
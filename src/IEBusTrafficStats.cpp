@@ -0,0 +1,90 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "IEBusTrafficStats.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <vector>
+
+#include "IEBusMessageDictionary.hpp"
+#include "IEBusText.hpp"
+
+namespace {
+
+auto constexpr LINE_LENGTH = 200;
+
+} // namespace
+
+auto IEBusTrafficStats::add(IEBusMessage const& message) -> void {
+  auto const [it, inserted] = m_streams.try_emplace(IEBusMessageDictionary::streamKey(message));
+  auto& stream = it->second;
+
+  if (inserted) {
+    stream.master = message.master;
+    stream.slave = message.slave;
+    stream.control = message.control;
+    stream.hasControl = message.hasControl;
+    stream.broadcast = message.isBroadcast();
+    stream.firstSample = message.startSample;
+  }
+
+  stream.messages++;
+  stream.naks += (message.flags & IEBusFlag::NAK) ? 1 : 0;
+  stream.parityErrors += (message.flags & IEBusFlag::PARITY_ERROR) ? 1 : 0;
+  stream.bytes += message.data.size();
+  stream.lastSample = message.startSample;
+
+  m_messages++;
+}
+
+auto IEBusTrafficStats::clear() -> void {
+  m_messages = 0;
+  m_streams.clear();
+}
+
+auto IEBusTrafficStats::onMessage(IEBusMessage const& message) -> void {
+  add(message);
+}
+
+auto IEBusTrafficStats::getMessageCount() const -> std::uint64_t {
+  return m_messages;
+}
+
+auto IEBusTrafficStats::write(std::ostream& stream, double sampleRateHz, std::uint64_t triggerSample) const -> void {
+  auto const time = IEBusTimeBase{sampleRateHz, triggerSample};
+
+  std::vector<std::pair<std::uint32_t, Stream const*>> sorted;
+  sorted.reserve(m_streams.size());
+  for (auto const& [key, entry] : m_streams) {
+    sorted.emplace_back(key, &entry);
+  }
+  std::ranges::sort(sorted, {}, &std::pair<std::uint32_t, Stream const*>::first);
+
+  stream << "Master,Slave,Control,Broadcast,Messages,NAK,Parity Error,Bytes,First [s],Last [s],Period [s]\n";
+
+  for (auto const& [key, entry] : sorted) {
+    auto const period = entry->messages > 1 ? (time.toSeconds(entry->lastSample) - time.toSeconds(entry->firstSample)) / static_cast<double>(entry->messages - 1) : 0.0;
+
+    auto line = std::array<char, LINE_LENGTH>();
+    auto const lineLength =
+        std::snprintf(line.data(), line.size(), "0x%03X,0x%03X,%s,%d,%llu,%llu,%llu,%llu,%.9f,%.9f,%.9f\n", entry->master, entry->slave,
+                      IEBusText::formatControl(entry->control, entry->hasControl),
+                      entry->broadcast ? 1 : 0, static_cast<unsigned long long>(entry->messages), static_cast<unsigned long long>(entry->naks),
+                      static_cast<unsigned long long>(entry->parityErrors), static_cast<unsigned long long>(entry->bytes), time.toSeconds(entry->firstSample),
+                      time.toSeconds(entry->lastSample), period);
+    stream.write(line.data(), lineLength);
+  }
+}
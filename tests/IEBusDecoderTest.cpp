@@ -0,0 +1,226 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Decodes a synthetic capture with run() and with edges pushed in chunks of several sizes, checks that
+// every listener call is the same, and that parity errors and NAKs end up on the expected messages.
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "IEBusDecoder.hpp"
+#include "IEBusTestCapture.hpp"
+
+namespace {
+
+auto constexpr SEED = 7;
+auto constexpr SAMPLE_RATE_HZ = 10000000.0;
+auto constexpr MESSAGES = 400;
+auto constexpr JITTER_SAMPLES = 15;
+auto constexpr CHUNK_SIZES = {1, 7, 4096};
+
+// the standard IEBus mode 2 timing at SAMPLE_RATE_HZ
+auto constexpr TIMING = IEBusTestTiming{1710, 1900, 200, 330, 390, 5000};
+
+// a capture as the line sees it, with the messages that went into it
+struct Capture {
+  std::vector<std::uint64_t> edges;
+  std::vector<IEBusMessage> messages;
+};
+
+auto makeCapture() -> Capture {
+  std::mt19937 rng(SEED);
+  IEBusTestCapture builder(TIMING, JITTER_SAMPLES, rng);
+  Capture capture;
+
+  for (auto i = 0; i < MESSAGES; i++) {
+    IEBusMessage message;
+    message.header = rng() % 8 == 0 ? 0 : 1;
+    message.master = static_cast<std::uint16_t>(rng() & 0xFFF);
+    message.slave = static_cast<std::uint16_t>(rng() & 0xFFF);
+    message.control = static_cast<std::uint8_t>(rng() & 0xF);
+    message.hasControl = true;
+    message.data.resize(rng() % 12);
+    for (auto& byte : message.data) {
+      byte = static_cast<std::uint8_t>(rng());
+    }
+    message.length = static_cast<std::uint8_t>(message.data.size());
+
+    auto fault = static_cast<IEBusTestFault>(rng() % 5);
+    if ((fault == IEBusTestFault::DataNak or fault == IEBusTestFault::DataParity) and message.data.empty()) {
+      fault = IEBusTestFault::None;
+    }
+    // nobody acknowledges a broadcast, so nobody can NAK it either
+    if ((fault == IEBusTestFault::AddressNak or fault == IEBusTestFault::DataNak) and message.isBroadcast()) {
+      fault = IEBusTestFault::None;
+    }
+    builder.add(message, fault);
+
+    // what the decoder should report for it
+    switch (fault) {
+    case IEBusTestFault::AddressNak:
+      message.flags = IEBusFlag::NAK;
+      message.control = 0;
+      message.length = 0;
+      message.hasControl = false;
+      message.data.clear();
+      break;
+    case IEBusTestFault::DataNak:
+      message.flags = IEBusFlag::NAK;
+      break;
+    case IEBusTestFault::ControlParity:
+    case IEBusTestFault::DataParity:
+      message.flags = IEBusFlag::PARITY_ERROR;
+      break;
+    case IEBusTestFault::None:
+      break;
+    }
+    capture.messages.push_back(message);
+  }
+
+  capture.edges = builder.getEdges();
+  return capture;
+}
+
+// writes every listener call as one line, so two decodes compare as strings
+class RecordingListener : public IEBusDecoderListener {
+public:
+  auto onMarker(std::uint64_t sample, Marker marker) -> void override {
+    append("marker %llu %d\n", static_cast<unsigned long long>(sample), static_cast<int>(marker));
+  }
+
+  auto onField(IEBusField const& field) -> void override {
+    append("field %llu %llu %llu %u %u\n", static_cast<unsigned long long>(field.startSample), static_cast<unsigned long long>(field.endSample),
+           static_cast<unsigned long long>(field.value), field.type, field.flags);
+  }
+
+  auto onMessage(IEBusMessage const& message) -> void override {
+    append("message %llu %llu %03X %03X %X %u %u %d", static_cast<unsigned long long>(message.startSample), static_cast<unsigned long long>(message.endSample),
+           message.master, message.slave, message.control, message.length, message.flags, message.hasControl ? 1 : 0);
+    for (auto const byte : message.data) {
+      append(" %02X", byte);
+    }
+    m_log += '\n';
+    m_messages.push_back(message);
+  }
+
+  auto onPulse(IEBusPulse const& pulse) -> void override {
+    append("pulse %llu %llu %d %d %d %d\n", static_cast<unsigned long long>(pulse.sample), static_cast<unsigned long long>(pulse.width), static_cast<int>(pulse.kind),
+           pulse.fromSlave ? 1 : 0, pulse.driven ? 1 : 0, pulse.nearThreshold ? 1 : 0);
+  }
+
+public:
+  [[nodiscard]] auto getLog() const -> std::string const& {
+    return m_log;
+  }
+
+  [[nodiscard]] auto getMessages() const -> std::vector<IEBusMessage> const& {
+    return m_messages;
+  }
+
+private:
+  template <typename... Args>
+  auto append(char const* format, Args... args) -> void {
+    auto line = std::array<char, 128>();
+    auto const length = std::snprintf(line.data(), line.size(), format, args...);
+    m_log.append(line.data(), static_cast<std::size_t>(length));
+  }
+
+private:
+  std::string m_log;
+  std::vector<IEBusMessage> m_messages;
+};
+
+class VectorEdgeSource : public IEBusEdgeSource {
+public:
+  explicit VectorEdgeSource(std::span<std::uint64_t const> edges) : m_edges(edges) {
+  }
+
+public:
+  [[nodiscard]] auto getSampleNumber() -> std::uint64_t override {
+    return m_position == 0 ? 0 : m_edges[m_position - 1];
+  }
+
+  [[nodiscard]] auto isHigh() -> bool override {
+    return m_position % 2 == 1;
+  }
+
+  auto advanceToNextEdge() -> bool override {
+    if (m_position == m_edges.size()) {
+      return false;
+    }
+    m_position++;
+    return true;
+  }
+
+private:
+  std::span<std::uint64_t const> m_edges;
+  std::size_t m_position = 0;
+};
+
+auto checkMessages(std::vector<IEBusMessage> const& decoded, std::vector<IEBusMessage> const& expected) -> bool {
+  if (decoded.size() != expected.size()) {
+    std::printf("run: %zu messages decoded, %zu expected\n", decoded.size(), expected.size());
+    return false;
+  }
+
+  for (std::size_t i = 0; i < expected.size(); i++) {
+    auto const& a = decoded[i];
+    auto const& b = expected[i];
+    if (a.header != b.header or a.master != b.master or a.slave != b.slave or a.control != b.control or a.length != b.length or a.flags != b.flags or
+        a.hasControl != b.hasControl or a.data != b.data) {
+      std::printf("run: message %zu is %03X->%03X flags %u, expected %03X->%03X flags %u\n", i, a.master, a.slave, a.flags, b.master, b.slave, b.flags);
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+auto main() -> int {
+  auto const capture = makeCapture();
+  auto const timing = IEBusTiming::fromMicroseconds(171.0, 39.0, SAMPLE_RATE_HZ);
+
+  RecordingListener reference;
+  IEBusDecoder referenceDecoder(timing, reference);
+  VectorEdgeSource source(capture.edges);
+  referenceDecoder.run(source);
+  auto ok = checkMessages(reference.getMessages(), capture.messages);
+
+  for (auto const chunkSize : CHUNK_SIZES) {
+    RecordingListener listener;
+    IEBusDecoder decoder(timing, listener);
+    decoder.setLineState(0, false);
+
+    std::span<std::uint64_t const> edges(capture.edges);
+    while (not edges.empty()) {
+      auto const count = std::min(edges.size(), static_cast<std::size_t>(chunkSize));
+      decoder.pushEdges(edges.first(count));
+      edges = edges.subspan(count);
+    }
+
+    if (listener.getLog() != reference.getLog()) {
+      std::printf("chunks of %d: listener calls differ from run()\n", chunkSize);
+      ok = false;
+    }
+  }
+
+  std::printf("%zu messages, %zu edges: %s\n", capture.messages.size(), capture.edges.size(), ok ? "ok" : "failed");
+  return ok ? 0 : 1;
+}
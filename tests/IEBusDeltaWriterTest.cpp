@@ -0,0 +1,139 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks that the delta export stays in time order and doesn't hold lines back behind a silent run.
+
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "IEBusDeltaWriter.hpp"
+
+namespace {
+
+auto constexpr SAMPLE_RATE_HZ = 1000000.0;
+auto constexpr MESSAGE_SAMPLES = 3000;
+auto constexpr CHANGING_MESSAGES = 20000;
+
+struct Line {
+  double time;
+  std::string event;
+};
+
+auto makeMessage(std::uint16_t master, std::uint8_t byte) -> IEBusMessage {
+  IEBusMessage message;
+  message.header = 1;
+  message.master = master;
+  message.slave = 0x1FF;
+  message.control = 0xF;
+  message.hasControl = true;
+  message.length = 1;
+  message.data = {byte};
+  return message;
+}
+
+auto readLines(std::string const& text) -> std::vector<Line> {
+  std::vector<Line> lines;
+  std::istringstream stream(text);
+  std::string line;
+  std::getline(stream, line);
+  while (std::getline(stream, line)) {
+    auto const comma = line.find(',');
+    lines.push_back({std::strtod(line.c_str(), nullptr), line.substr(comma + 1, line.find(',', comma + 1) - comma - 1)});
+  }
+  return lines;
+}
+
+auto isOrdered(char const* name, std::vector<Line> const& lines) -> bool {
+  for (std::size_t i = 1; i < lines.size(); i++) {
+    if (lines[i].time < lines[i - 1].time) {
+      std::printf("%s: line %zu at %.6f s follows %.6f s\n", name, i + 1, lines[i].time, lines[i - 1].time);
+      return false;
+    }
+  }
+  return true;
+}
+
+// a run of one stream is still open while another stream changes, its repeat line goes in between
+auto checkInterleaved() -> bool {
+  struct Step {
+    std::uint16_t master;
+    std::uint8_t byte;
+  };
+  std::vector<Step> const steps = {Step{0x190, 1}, Step{0x190, 1}, Step{0x190, 1}, Step{0x110, 1}, Step{0x110, 2},
+                                   Step{0x110, 3}, Step{0x190, 2}, Step{0x110, 3}, Step{0x110, 3}, Step{0x110, 4}};
+
+  std::ostringstream output;
+  IEBusDeltaWriter writer(output, SAMPLE_RATE_HZ);
+  std::uint64_t sample = 0;
+  for (auto const step : steps) {
+    auto message = makeMessage(step.master, step.byte);
+    message.startSample = sample += MESSAGE_SAMPLES;
+    writer.onMessage(message);
+  }
+  writer.finish();
+
+  auto const lines = readLines(output.str());
+  std::vector<std::string> events;
+  for (auto const& line : lines) {
+    events.push_back(line.event);
+  }
+  if (events != std::vector<std::string>{"new", "repeat", "new", "change", "change", "change", "repeat", "change"}) {
+    std::printf("interleaved: unexpected line sequence\n");
+    return false;
+  }
+  return isOrdered("interleaved", lines);
+}
+
+// a stream that repeats once and goes quiet must not keep every later line in memory until finish
+auto checkSilentRun() -> bool {
+  std::ostringstream output;
+  IEBusDeltaWriter writer(output, SAMPLE_RATE_HZ);
+  std::uint64_t sample = 0;
+  for (auto i = 0; i < 2; i++) {
+    auto message = makeMessage(0x190, 0);
+    message.startSample = sample += MESSAGE_SAMPLES;
+    writer.onMessage(message);
+  }
+  for (auto i = 0; i < CHANGING_MESSAGES; i++) {
+    auto message = makeMessage(0x110, static_cast<std::uint8_t>(i));
+    message.startSample = sample += MESSAGE_SAMPLES;
+    writer.onMessage(message);
+  }
+
+  auto const written = readLines(output.str()).size();
+  if (written + IEBusDeltaWriter::MAX_SILENT_MESSAGES + 1 < CHANGING_MESSAGES) {
+    std::printf("silent run: only %zu of %d lines written before finish\n", written, CHANGING_MESSAGES + 2);
+    return false;
+  }
+
+  writer.finish();
+  auto const lines = readLines(output.str());
+  if (lines.size() != CHANGING_MESSAGES + 2 or lines[1].event != "repeat") {
+    std::printf("silent run: %zu lines, second is %s\n", lines.size(), lines[1].event.c_str());
+    return false;
+  }
+  return isOrdered("silent run", lines);
+}
+
+} // namespace
+
+auto main() -> int {
+  auto ok = checkInterleaved();
+  ok = checkSilentRun() and ok;
+  std::printf("%s\n", ok ? "delta writer ok" : "delta writer failed");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks IEBusEventMatcher against a rule-by-rule evaluation of random rules and messages.
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "IEBusEventMatcher.hpp"
+
+namespace {
+
+auto constexpr SEED = 5;
+auto constexpr RANDOM_RULES = 300;
+auto constexpr MESSAGES = 200000;
+// wildcard heavy rules with one fixed byte each, a subset construction over these needs billions of states
+auto constexpr WILDCARD_RULES = 48;
+auto constexpr WILDCARD_DEPTH = 8;
+
+auto matchesRule(IEBusEventRule const& rule, IEBusMessage const& message) -> bool {
+  if ((message.master & rule.masterMask) != rule.master or (message.slave & rule.slaveMask) != rule.slave) {
+    return false;
+  }
+  if ((message.flags & rule.flags) != rule.flags) {
+    return false;
+  }
+  // without a control field only rules that don't look at control and length apply
+  if (not message.hasControl) {
+    return rule.controls == 0xFFFF and not rule.length and rule.data.empty() and (not rule.broadcast or *rule.broadcast == message.isBroadcast());
+  }
+  if ((rule.controls >> message.control & 1) == 0) {
+    return false;
+  }
+  if ((rule.broadcast and *rule.broadcast != message.isBroadcast()) or (rule.length and *rule.length != message.length)) {
+    return false;
+  }
+  if (message.data.size() < rule.data.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < rule.data.size(); i++) {
+    if ((message.data[i] & rule.data[i].mask) != rule.data[i].value) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto randomRule(std::mt19937& rng, int id) -> IEBusEventRule {
+  IEBusEventRule rule;
+  rule.name = "r" + std::to_string(id);
+  if (rng() % 2) {
+    rule.masterMask = static_cast<std::uint16_t>(rng() & 0xFFF);
+    rule.master = static_cast<std::uint16_t>(rng() & rule.masterMask);
+  }
+  if (rng() % 2) {
+    rule.slaveMask = static_cast<std::uint16_t>(rng() & 0xFFF);
+    rule.slave = static_cast<std::uint16_t>(rng() & rule.slaveMask);
+  }
+  if (rng() % 2) {
+    rule.controls = static_cast<std::uint16_t>(rng() | 1);
+  }
+  if (rng() % 4 == 0) {
+    rule.flags = static_cast<std::uint8_t>(rng() % 4);
+  }
+  if (rng() % 4 == 0) {
+    rule.broadcast = rng() % 2 == 0;
+  }
+  if (rng() % 5 == 0) {
+    rule.length = static_cast<std::uint8_t>(rng() % 4);
+  }
+  for (auto n = rng() % 4; n > 0; n--) {
+    IEBusEventRule::BytePattern pattern;
+    pattern.mask = rng() % 3 == 0 ? 0 : (rng() % 2 ? 0xFF : 0xF0);
+    pattern.value = static_cast<std::uint8_t>(rng() & pattern.mask);
+    rule.data.push_back(pattern);
+  }
+  return rule;
+}
+
+auto randomMessage(std::mt19937& rng, std::vector<IEBusEventRule> const& rules, std::size_t maxLength) -> IEBusMessage {
+  IEBusMessage message;
+  message.header = static_cast<std::uint8_t>(rng() % 2);
+  message.master = static_cast<std::uint16_t>(rng() & 0xFFF);
+  message.slave = static_cast<std::uint16_t>(rng() & 0xFFF);
+  message.control = static_cast<std::uint8_t>(rng() & 0xF);
+  message.flags = static_cast<std::uint8_t>(rng() % 4);
+  message.hasControl = true;
+
+  // half of the messages are aimed at a rule's addresses, or hardly anything would match
+  if (rng() % 2) {
+    auto const& rule = rules[rng() % rules.size()];
+    message.master = static_cast<std::uint16_t>(rule.master | (rng() & ~rule.masterMask & 0xFFF));
+    message.slave = static_cast<std::uint16_t>(rule.slave | (rng() & ~rule.slaveMask & 0xFFF));
+  }
+
+  // few distinct byte values, so patterns match often
+  auto const length = rng() % (maxLength + 1);
+  for (std::size_t i = 0; i < length; i++) {
+    message.data.push_back(static_cast<std::uint8_t>(rng() % 4 == 0 ? rng() & 0xFF : (rng() % 2 ? 0x00 : 0x10)));
+  }
+  message.length = static_cast<std::uint8_t>(length);
+
+  // a slave that NAKs its address ends the message before control and length
+  if (rng() % 10 == 0) {
+    message.flags |= IEBusFlag::NAK;
+    message.control = 0;
+    message.length = 0;
+    message.data.clear();
+    message.hasControl = false;
+  }
+  return message;
+}
+
+auto check(char const* name, std::vector<IEBusEventRule> const& rules, std::mt19937& rng, std::size_t maxLength) -> bool {
+  IEBusEventMatcher matcher;
+  for (auto const& rule : rules) {
+    matcher.add(rule);
+  }
+  matcher.compile(1000000.0);
+
+  std::vector<std::uint32_t> hits;
+  std::vector<std::uint32_t> expected;
+  std::size_t total = 0;
+  for (auto i = 0; i < MESSAGES; i++) {
+    auto const message = randomMessage(rng, rules, maxLength);
+    matcher.match(message, hits);
+
+    expected.clear();
+    for (std::uint32_t id = 0; id < rules.size(); id++) {
+      if (matchesRule(rules[id], message)) {
+        expected.push_back(id);
+      }
+    }
+    if (hits != expected) {
+      std::printf("%s: message %d matched %zu rules, expected %zu\n", name, i, hits.size(), expected.size());
+      return false;
+    }
+    total += hits.size();
+  }
+
+  std::printf("%s: %zu hits over %d messages\n", name, total, MESSAGES);
+  return true;
+}
+
+} // namespace
+
+auto main() -> int {
+  std::mt19937 rng(SEED);
+
+  std::vector<IEBusEventRule> rules;
+  for (auto i = 0; i < RANDOM_RULES; i++) {
+    rules.push_back(randomRule(rng, i));
+  }
+  auto ok = check("random rules", rules, rng, 5);
+
+  rules.clear();
+  for (auto i = 0; i < WILDCARD_RULES; i++) {
+    IEBusEventRule rule;
+    rule.name = "w" + std::to_string(i);
+    rule.data.resize(WILDCARD_DEPTH);
+    rule.data[i % WILDCARD_DEPTH] = {static_cast<std::uint8_t>(i / WILDCARD_DEPTH * 0x10), 0xFF};
+    rules.push_back(rule);
+  }
+  ok = check("wildcard rules", rules, rng, WILDCARD_DEPTH + 2) and ok;
+
+  return ok ? 0 : 1;
+}
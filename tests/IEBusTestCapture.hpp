@@ -0,0 +1,101 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "IEBusMessage.hpp"
+
+// widths of the rendered pulses, in samples
+struct IEBusTestTiming {
+  std::uint64_t startHigh = 0;
+  std::uint64_t startPeriod = 0;
+  std::uint64_t oneHigh = 0;
+  std::uint64_t zeroHigh = 0;
+  std::uint64_t bitPeriod = 0;
+  std::uint64_t messageGap = 0;
+};
+
+// what goes wrong on the bus while a message is rendered
+enum class IEBusTestFault { None, AddressNak, DataNak, ControlParity, DataParity };
+
+// Renders messages into the edges the line shows, starting low, with a random jitter on every high pulse.
+class IEBusTestCapture {
+public:
+  IEBusTestCapture(IEBusTestTiming const& timing, std::uint64_t jitter, std::mt19937& rng) : m_timing(timing), m_jitter(jitter), m_rng(rng) {
+  }
+
+public:
+  auto add(IEBusMessage const& message, IEBusTestFault fault = IEBusTestFault::None) -> void {
+    auto const individual = not message.isBroadcast();
+    auto const ack = [&](bool nak) { return individual ? nak : true; };
+
+    pulse(m_timing.startHigh, m_timing.startPeriod);
+    bits(message.header, 1);
+    field(message.master, 12, false);
+    field(message.slave, 12, false);
+    bit(ack(fault == IEBusTestFault::AddressNak));
+    if (fault != IEBusTestFault::AddressNak) {
+      field(message.control, 4, fault == IEBusTestFault::ControlParity);
+      bit(ack(false));
+      field(message.length, 8, false);
+      bit(ack(false));
+      for (std::size_t i = 0; i < message.data.size(); i++) {
+        field(message.data[i], 8, fault == IEBusTestFault::DataParity and i == 0);
+        bit(ack(fault == IEBusTestFault::DataNak and i + 1 == message.data.size()));
+      }
+    }
+    m_sample += m_timing.messageGap;
+  }
+
+  [[nodiscard]] auto getEdges() const -> std::vector<std::uint64_t> const& {
+    return m_edges;
+  }
+
+private:
+  auto pulse(std::uint64_t high, std::uint64_t period) -> void {
+    auto const jitter = static_cast<std::int64_t>(m_rng() % (2 * m_jitter + 1)) - static_cast<std::int64_t>(m_jitter);
+    m_edges.push_back(m_sample);
+    m_edges.push_back(m_sample + static_cast<std::uint64_t>(static_cast<std::int64_t>(high) + jitter));
+    m_sample += period;
+  }
+
+  auto bit(bool one) -> void {
+    pulse(one ? m_timing.oneHigh : m_timing.zeroHigh, m_timing.bitPeriod);
+  }
+
+  auto bits(std::uint32_t value, int count) -> void {
+    for (auto i = count - 1; i >= 0; i--) {
+      bit((value >> i & 1) != 0);
+    }
+  }
+
+  // the parity bit makes the number of ones even, badParity flips it
+  auto field(std::uint32_t value, int count, bool badParity) -> void {
+    bits(value, count);
+    bit(((std::popcount(value) & 1) != 0) != badParity);
+  }
+
+private:
+  IEBusTestTiming m_timing;
+  std::uint64_t m_jitter;
+  std::mt19937& m_rng;
+  std::vector<std::uint64_t> m_edges;
+  std::uint64_t m_sample = 1000;
+};
@@ -0,0 +1,140 @@
+// Copyright 2026 Pavel Suprunov
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Renders captures at several bit rates, checks the widths the detector finds and that the decoder
+// gets every message back with them.
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "IEBusDecoder.hpp"
+#include "IEBusTestCapture.hpp"
+#include "IEBusTimingDetector.hpp"
+
+namespace {
+
+auto constexpr SEED = 11;
+auto constexpr SAMPLE_RATE_HZ = 10000000.0;
+auto constexpr MESSAGES = 200;
+// of the nominal width, covers the jitter and the rounding of the one/zero estimate
+auto constexpr TOLERANCE = 0.03;
+
+struct Case {
+  char const* name;
+  IEBusTestTiming timing;
+  double startUs;
+  double bitUs;
+  bool zeroPayload;
+};
+
+class CountingListener : public IEBusDecoderListener {
+public:
+  auto onMessage(IEBusMessage const& message) -> void override {
+    m_messages.push_back(message);
+  }
+
+public:
+  std::vector<IEBusMessage> m_messages;
+};
+
+auto isNear(double value, double nominal) -> bool {
+  return std::abs(value - nominal) <= nominal * TOLERANCE;
+}
+
+auto check(Case const& test) -> bool {
+  std::mt19937 rng(SEED);
+  IEBusTestCapture capture(test.timing, test.timing.oneHigh / 40, rng);
+
+  std::vector<IEBusMessage> messages;
+  for (auto i = 0; i < MESSAGES; i++) {
+    IEBusMessage message;
+    message.header = 1;
+    message.master = static_cast<std::uint16_t>(rng() & 0xFFF);
+    message.slave = static_cast<std::uint16_t>(rng() & 0xFFF);
+    message.control = static_cast<std::uint8_t>(rng() & 0xF);
+    message.hasControl = true;
+    message.data.resize(test.zeroPayload ? 32 : rng() % 8);
+    for (auto& byte : message.data) {
+      byte = test.zeroPayload ? 0 : static_cast<std::uint8_t>(rng());
+    }
+    message.length = static_cast<std::uint8_t>(message.data.size());
+    capture.add(message);
+    messages.push_back(message);
+  }
+
+  IEBusTimingDetector detector;
+  auto high = false;
+  for (auto const sample : capture.getEdges()) {
+    high = not high;
+    if (not detector.addEdge(sample, high)) {
+      break;
+    }
+  }
+
+  auto const detected = detector.detect();
+  if (not detected) {
+    std::printf("%s: timing not detected\n", test.name);
+    return false;
+  }
+
+  auto const samplesPerUs = SAMPLE_RATE_HZ / 1000000.0;
+  auto const startUs = static_cast<double>(detected->timing.startBitWidth) / samplesPerUs;
+  auto const bitUs = static_cast<double>(detected->timing.dataBitWidth) / samplesPerUs;
+  if (not isNear(startUs, test.startUs) or not isNear(bitUs, test.bitUs)) {
+    std::printf("%s: start bit %.1f uS, bit %.1f uS, expected %.1f uS and %.1f uS\n", test.name, startUs, bitUs, test.startUs, test.bitUs);
+    return false;
+  }
+
+  CountingListener listener;
+  IEBusDecoder decoder(detected->timing, listener);
+  decoder.setLineState(0, false);
+  decoder.pushEdges(capture.getEdges());
+  if (listener.m_messages.size() != messages.size()) {
+    std::printf("%s: %zu of %zu messages decoded\n", test.name, listener.m_messages.size(), messages.size());
+    return false;
+  }
+  for (std::size_t i = 0; i < messages.size(); i++) {
+    if (listener.m_messages[i].master != messages[i].master or listener.m_messages[i].data != messages[i].data or listener.m_messages[i].flags != 0) {
+      std::printf("%s: message %zu decoded wrong\n", test.name, i);
+      return false;
+    }
+  }
+
+  std::printf("%s: start bit %.1f uS, bit %.1f uS\n", test.name, startUs, bitUs);
+  return true;
+}
+
+} // namespace
+
+auto main() -> int {
+  // widths in samples at SAMPLE_RATE_HZ: start high and period, one and zero high, bit period, gap
+  auto const cases = {
+      Case{"mode 2", {1710, 1900, 200, 330, 390, 5000}, 171.0, 39.0, false},
+      // twice the data bit time with the usual start bit, only 2.6 times the zero bit
+      Case{"slow data bits", {1710, 1900, 400, 660, 780, 5000}, 171.0, 78.0, false},
+      // mode 0, every width about nine times that of mode 2
+      Case{"mode 0", {15170, 16860, 1730, 3030, 3460, 40000}, 1517.0, 346.0, false},
+      // only the header, addresses, control and length carry one bits
+      Case{"zero payload", {1710, 1900, 200, 330, 390, 5000}, 171.0, 39.0, true},
+  };
+
+  auto ok = true;
+  for (auto const& test : cases) {
+    ok = check(test) and ok;
+  }
+  return ok ? 0 : 1;
+}